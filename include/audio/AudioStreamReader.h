@@ -0,0 +1,86 @@
+#ifndef AUDIOSTREAMREADER_H
+#define AUDIOSTREAMREADER_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "audio/Decimator.h"
+
+typedef struct sf_private_tag SNDFILE;
+
+/**
+ * @brief Leitura de um canal direto do arquivo, sem decodificá-lo inteiro
+ *
+ * Lê blocos com sf_seek/sf_readf_float e mantém apenas um buffer circular
+ * de `capacity` amostras (já decimadas), de modo que a memória usada não
+ * depende da duração do arquivo. Leituras que avançam (frames
+ * consecutivos da STFT) reaproveitam a sobreposição e decodificam só as
+ * amostras novas; saltos para trás ou grandes saltos para frente
+ * reposicionam o arquivo.
+ *
+ * Com fator de decimação > 1 as amostras passam pelo mesmo filtro de
+ * Decimator::decimate(): a amostra j corresponde à entrada j * factor.
+ *
+ * Não é seguro entre threads: use uma instância por thread.
+ */
+class AudioStreamReader
+{
+public:
+    /**
+     * @brief Abre o arquivo
+     * @param filePath Caminho do arquivo
+     * @param channel Canal lido
+     * @param downsampleFactor Fator de decimação (1 = taxa original)
+     * @param capacity Máximo de amostras por leitura (tamanho do buffer)
+     */
+    AudioStreamReader(const QString &filePath, int channel, int downsampleFactor, int capacity);
+    ~AudioStreamReader();
+
+    bool isOpen() const { return m_file != nullptr; }
+    QString getLastError() const { return m_lastError; }
+
+    int sampleRate() const { return m_sampleRate; }
+
+    /**
+     * @brief Número de amostras após a decimação
+     */
+    qint64 numSamples() const { return m_numSamples; }
+
+    /**
+     * @brief Lê as amostras [start, start + count) (domínio decimado)
+     *
+     * Posições fora do sinal viram zero.
+     * @param count No máximo a capacidade do buffer
+     * @return false em erro de leitura (dst é preenchido com zeros)
+     */
+    bool read(qint64 start, int count, float *dst);
+
+private:
+    bool seekTo(qint64 start);
+    bool fill(qint64 end);
+    int readInput(int frames);
+
+    SNDFILE *m_file;
+    QString m_lastError;
+    int m_channel;
+    int m_numChannels;
+    int m_sampleRate;
+    int m_factor;
+    qint64 m_inputFrames;               // Amostras originais por canal
+    qint64 m_numSamples;                // Amostras decimadas
+
+    // Buffer circular: amostras [m_bufferStart, m_bufferStart + m_bufferCount)
+    QVector<float> m_ring;
+    int m_ringHead;                     // Posição de m_bufferStart em m_ring
+    qint64 m_bufferStart;
+    int m_bufferCount;
+
+    std::unique_ptr<Decimator> m_decimator;
+    qint64 m_inputPosition;             // Próxima amostra original a ler
+    int m_warmup;                       // Entradas antes da primeira saída após seekTo
+    QVector<float> m_interleaved;       // Bloco lido do arquivo
+    QVector<float> m_input;             // Canal extraído do bloco
+    QVector<float> m_output;            // Saída do decimador
+};
+
+#endif // AUDIOSTREAMREADER_H
@@ -8,6 +8,7 @@
 #include <portaudio.h>
 
 class AudioFile;
+class PlaybackStream;
 
 /**
  * @brief Player de áudio customizado usando PortAudio
@@ -17,6 +18,9 @@ class AudioFile;
  * - Loop perfeito
  * - Seek instantâneo
  * - Controle total do buffer
+ *
+ * Arquivos abertos sem amostras na memória (acima de "audio/maxDecodedMB")
+ * são reproduzidos em fluxo, lidos do arquivo por um PlaybackStream.
  */
 class CustomAudioPlayer : public QObject
 {
@@ -155,6 +159,9 @@ private:
     // Dados do áudio
     std::shared_ptr<AudioFile> m_audioFile;
     std::vector<float> m_samples;
+    std::unique_ptr<PlaybackStream> m_playbackStream;   // Sem amostras na memória
+    std::vector<float> m_streamBlock;                   // Bloco lido do stream pelo callback
+    size_t m_numSamples;
     int m_sampleRate;
     int m_channels;
 
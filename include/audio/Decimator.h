@@ -0,0 +1,67 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <QVector>
+
+/**
+ * @brief Decimador polifásico com filtro FIR anti-aliasing
+ *
+ * O filtro passa-baixas (sinc janelado com Blackman, simétrico) é calculado
+ * uma única vez no construtor. Apenas uma a cada `factor` saídas do filtro
+ * é computada, o que equivale à decomposição polifásica: o custo é de
+ * numTaps / factor multiplicações por amostra de entrada.
+ *
+ * Pode ser usado em fluxo (process() por blocos, com o histórico mantido
+ * entre chamadas) ou sobre um sinal inteiro (decimate()).
+ */
+class Decimator
+{
+public:
+    /**
+     * @brief Construtor
+     * @param factor Fator de decimação (>= 1)
+     * @param tapsPerPhase Coeficientes por fase (comprimento = factor * tapsPerPhase + 1)
+     */
+    explicit Decimator(int factor, int tapsPerPhase = 16);
+
+    int factor() const { return m_factor; }
+    int numTaps() const { return m_kernel.size(); }
+
+    /**
+     * @brief Atraso do filtro em amostras de entrada (fase linear)
+     */
+    int delay() const { return (m_kernel.size() - 1) / 2; }
+
+    const QVector<float>& kernel() const { return m_kernel; }
+
+    /**
+     * @brief Reinicia o histórico
+     * @param firstOutput Índice da amostra de entrada da primeira saída
+     */
+    void reset(int firstOutput = 0);
+
+    /**
+     * @brief Processa um bloco de amostras
+     * @param input Amostras de entrada
+     * @param count Número de amostras de entrada
+     * @param output Destino (capacidade mínima: count / factor + 1)
+     * @return Número de amostras escritas em output
+     */
+    int process(const float *input, int count, float *output);
+
+    /**
+     * @brief Decima um sinal inteiro, compensando o atraso do filtro
+     *
+     * A saída j corresponde à entrada j * factor; o resultado tem
+     * ceil(input.size() / factor) amostras.
+     */
+    static QVector<float> decimate(const QVector<float> &input, int factor);
+
+private:
+    int m_factor;
+    QVector<float> m_kernel;
+    QVector<float> m_buffer;        // Histórico (numTaps - 1) + bloco atual
+    int m_nextOutput;               // Posição da próxima saída no bloco seguinte
+};
+
+#endif // DECIMATOR_H
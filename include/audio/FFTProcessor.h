@@ -0,0 +1,77 @@
+#ifndef FFTPROCESSOR_H
+#define FFTPROCESSOR_H
+
+#include <QString>
+#include <complex>
+#include <fftw3.h>
+
+/**
+ * @brief FFT real -> complexa usando FFTW (precisão simples)
+ *
+ * Cada instância possui seus próprios buffers alinhados (fftwf_malloc).
+ * Os planos são compartilhados através de um cache por tamanho de FFT e
+ * executados com fftwf_execute_dft_r2c, o que permite usar várias
+ * instâncias do mesmo tamanho em paralelo.
+ *
+ * A "wisdom" do FFTW é salva no diretório de configuração do usuário
+ * para que os planos não sejam medidos novamente a cada execução.
+ */
+class FFTProcessor
+{
+public:
+    /**
+     * @brief Construtor
+     * @param fftSize Tamanho da FFT (número de amostras reais)
+     */
+    explicit FFTProcessor(int fftSize);
+    ~FFTProcessor();
+
+    FFTProcessor(const FFTProcessor&) = delete;
+    FFTProcessor& operator=(const FFTProcessor&) = delete;
+
+    int size() const { return m_size; }
+    int numBins() const { return m_size / 2 + 1; }
+
+    /**
+     * @brief Buffer de entrada com size() amostras (alinhado)
+     */
+    float* input() { return m_input; }
+
+    /**
+     * @brief Executa a FFT sobre input()
+     */
+    void execute();
+
+    /**
+     * @brief Resultado da última execução (numBins() valores)
+     */
+    const std::complex<float>* output() const {
+        return reinterpret_cast<const std::complex<float>*>(m_output);
+    }
+
+    /**
+     * @brief Carrega a wisdom salva (chamado automaticamente no primeiro plano)
+     */
+    static void loadWisdom();
+
+    /**
+     * @brief Salva a wisdom acumulada no diretório de configuração
+     */
+    static void saveWisdom();
+
+    /**
+     * @brief Caminho do arquivo de wisdom
+     */
+    static QString wisdomFilePath();
+
+private:
+    static fftwf_plan planForSize(int fftSize);
+
+private:
+    int m_size;
+    float *m_input;
+    fftwf_complex *m_output;
+    fftwf_plan m_plan;
+};
+
+#endif // FFTPROCESSOR_H
@@ -0,0 +1,131 @@
+#ifndef FREQUENCYSCALE_H
+#define FREQUENCYSCALE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Escala do eixo de frequência (linear, logarítmica, Bark ou ERB)
+ *
+ * Converte entre frequência (Hz) e posição no eixo, de 0 (minFrequency)
+ * a 1 (maxFrequency). A escala afeta apenas a exibição: os tiles guardam
+ * sempre os bins lineares da FFT, reamostrados por uma FrequencyRemap.
+ */
+class FrequencyScale
+{
+public:
+    enum Type {
+        Linear,
+        Logarithmic,
+        Bark,           // Traunmüller (1990)
+        Erb             // Glasberg & Moore (1990)
+    };
+
+    explicit FrequencyScale(Type type = Linear, double minFrequency = 0.0, double maxFrequency = 1.0);
+
+    Type type() const { return m_type; }
+    double minFrequency() const { return m_minFrequency; }
+    double maxFrequency() const { return m_maxFrequency; }
+
+    /**
+     * @brief Posição no eixo (0 a 1) de uma frequência em Hz
+     */
+    double toPosition(double frequency) const;
+
+    /**
+     * @brief Frequência em Hz de uma posição no eixo (0 a 1)
+     */
+    double toFrequency(double position) const;
+
+    /**
+     * @brief Valor na escala (log Hz, Bark ou ERB-rate) de uma frequência
+     */
+    static double toScale(Type type, double frequency);
+    static double fromScale(Type type, double value);
+
+    /**
+     * @brief Tipo pelo nome usado nas configurações ("Linear", "Log", "Bark", "ERB")
+     */
+    static Type typeFromName(const QString &name);
+    static QStringList names();
+
+private:
+    Type m_type;
+    double m_minFrequency;
+    double m_maxFrequency;
+    double m_scaleMin;
+    double m_scaleMax;
+};
+
+/**
+ * @brief Tabela de reamostragem dos bins lineares para as linhas da escala
+ *
+ * Calculada uma vez por escala e geometria. Cada linha (0 = frequência
+ * mais baixa) interpola entre dois bins vizinhos quando cobre menos de um
+ * bin, ou usa o máximo dos bins que cobre, para não perder picos
+ * estreitos nas regiões comprimidas do eixo.
+ */
+struct FrequencyRemap {
+    int numRows = 0;
+    int numBins = 0;
+    QVector<int> firstBin;
+    QVector<int> lastBin;       // Inclusivo
+    QVector<float> fraction;    // Peso de lastBin na interpolação; < 0: máximo
+
+    bool isNull() const { return numRows == 0; }
+
+    /**
+     * @brief Monta a tabela
+     * @param scale Escala do eixo
+     * @param binFrequency Largura de um bin em Hz (sampleRate / fftSize)
+     * @param minBin Primeiro bin guardado nos tiles
+     * @param numBins Número de bins guardados nos tiles
+     * @param numRows Número de linhas da imagem
+     */
+    static FrequencyRemap build(const FrequencyScale &scale, double binFrequency,
+                                int minBin, int numBins, int numRows);
+
+    /**
+     * @brief Aplica a tabela a uma coluna de dB (numBins valores)
+     * @param column Coluna do tile
+     * @param row Linha desejada
+     */
+    float value(const float *column, int row) const {
+        int first = firstBin[row];
+        int last = lastBin[row];
+        float weight = fraction[row];
+        if (weight >= 0.0f) {
+            return column[first] + (column[last] - column[first]) * weight;
+        }
+        float result = column[first];
+        for (int bin = first + 1; bin <= last; ++bin) {
+            result = result > column[bin] ? result : column[bin];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Aplica a tabela a uma coluna de níveis quantizados
+     *
+     * Os níveis são lineares em dB: interpolar ou tomar o máximo deles
+     * equivale a fazê-lo em dB e quantizar.
+     * @param column Coluna de níveis do tile (numBins valores)
+     * @param row Linha desejada
+     */
+    quint8 level(const quint8 *column, int row) const {
+        int first = firstBin[row];
+        int last = lastBin[row];
+        float weight = fraction[row];
+        if (weight >= 0.0f) {
+            return static_cast<quint8>(column[first] + (column[last] - column[first]) * weight + 0.5f);
+        }
+        quint8 result = column[first];
+        for (int bin = first + 1; bin <= last; ++bin) {
+            result = result > column[bin] ? result : column[bin];
+        }
+        return result;
+    }
+};
+
+#endif // FREQUENCYSCALE_H
@@ -0,0 +1,74 @@
+#ifndef PLAYBACKSTREAM_H
+#define PLAYBACKSTREAM_H
+
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+class QThread;
+
+/**
+ * @brief Fonte de reprodução lida do arquivo, para arquivos não decodificados
+ *
+ * Uma thread lê o canal com AudioStreamReader à frente da posição de
+ * reprodução e o guarda num buffer circular de `capacity` amostras; a
+ * memória usada não depende da duração do arquivo. read() é chamado pelo
+ * callback de áudio e nunca bloqueia: se a thread estiver escrevendo no
+ * buffer, ou se a posição pedida ainda não foi lida (início, seek, volta
+ * do loop), devolve silêncio e pede a leitura a partir daquela posição.
+ */
+class PlaybackStream
+{
+public:
+    /**
+     * @brief Abre o arquivo e inicia a leitura a partir do início
+     * @param filePath Caminho do arquivo
+     * @param channel Canal reproduzido
+     * @param capacity Amostras mantidas à frente da reprodução
+     */
+    PlaybackStream(const QString &filePath, int channel, int capacity);
+    ~PlaybackStream();
+
+    bool isOpen() const { return m_numSamples > 0; }
+    QString getLastError() const { return m_lastError; }
+
+    qint64 numSamples() const { return m_numSamples; }
+
+    /**
+     * @brief Passa a ler a partir de uma posição (seek)
+     */
+    void seek(qint64 position);
+
+    /**
+     * @brief Copia as amostras [position, position + count) (callback de áudio)
+     *
+     * Amostras ainda não lidas viram zero.
+     * @return false se alguma amostra faltou
+     */
+    bool read(qint64 position, int count, float *dst);
+
+private:
+    void run();
+
+    QString m_filePath;
+    int m_channel;
+    QString m_lastError;
+    qint64 m_numSamples;
+
+    // Buffer circular: amostras [m_windowStart, m_windowStart + m_windowCount),
+    // a amostra n em m_ring[n % capacidade]
+    QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+    QVector<float> m_ring;
+    qint64 m_windowStart;
+    int m_windowCount;
+
+    std::atomic<qint64> m_readPosition;         // Fim da última leitura do callback
+    std::atomic<qint64> m_requestedPosition;    // Seek pendente (-1: nenhum)
+    std::atomic<bool> m_stop;
+    QThread *m_thread;
+};
+
+#endif // PLAYBACKSTREAM_H
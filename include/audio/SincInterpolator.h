@@ -0,0 +1,42 @@
+#ifndef SINCINTERPOLATOR_H
+#define SINCINTERPOLATOR_H
+
+#include <QVector>
+
+/**
+ * @brief Interpolação de banda limitada (sinc janelado) entre amostras
+ *
+ * Reconstrói o sinal em posições fracionárias a partir das amostras
+ * vizinhas. Os coeficientes (sinc janelado com Blackman, normalizados para
+ * ganho unitário em DC) são calculados uma única vez no construtor, em uma
+ * tabela polifásica: cada posição usa a fase mais próxima, e o custo é de
+ * 2 * tapsPerSide multiplicações por valor.
+ */
+class SincInterpolator
+{
+public:
+    /**
+     * @brief Construtor
+     * @param tapsPerSide Amostras usadas de cada lado da posição
+     * @param numPhases Fases da tabela (resolução da posição fracionária)
+     */
+    explicit SincInterpolator(int tapsPerSide = 8, int numPhases = 256);
+
+    int tapsPerSide() const { return m_tapsPerSide; }
+    int numPhases() const { return m_numPhases; }
+
+    /**
+     * @brief Valor reconstruído em uma posição fracionária
+     * @param samples Amostras
+     * @param count Número de amostras (fora de [0, count) valem zero)
+     * @param position Posição, em amostras
+     */
+    float valueAt(const float *samples, int count, double position) const;
+
+private:
+    int m_tapsPerSide;
+    int m_numPhases;
+    QVector<float> m_table;     // numPhases x (2 * tapsPerSide)
+};
+
+#endif // SINCINTERPOLATOR_H
@@ -0,0 +1,164 @@
+#ifndef SPECTROGRAMCACHE_H
+#define SPECTROGRAMCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include "audio/SpectrogramCalculator.h"
+#include "audio/SpectrogramTile.h"
+
+/**
+ * @brief Chave de um tile no cache em memória
+ *
+ * Identifica o arquivo (AudioFile::getId), os parâmetros de análise e a
+ * posição do tile na pirâmide. Parâmetros de exibição (mapa de cores,
+ * faixa dinâmica) não fazem parte da chave.
+ */
+struct SpectrogramCacheKey {
+    quint64 fileId = 0;
+    SpectrogramCalculator::Parameters params;
+    int level = 0;
+    int index = 0;
+
+    bool operator==(const SpectrogramCacheKey &other) const {
+        return fileId == other.fileId && level == other.level &&
+               index == other.index && params == other.params;
+    }
+};
+
+size_t qHash(const SpectrogramCacheKey &key, size_t seed = 0);
+
+/**
+ * @brief Cache LRU de tiles de espectrograma compartilhado pelo projeto
+ *
+ * Guarda tiles de todos os arquivos e de várias configurações ao mesmo
+ * tempo (alternar entre presets não recalcula), limitado por um orçamento
+ * de memória em MB (QSettings "spectrogram/memoryCacheMB"). Seguro para
+ * uso a partir de várias threads.
+ *
+ * No modo quantizado (padrão, QSettings "spectrogram/quantizedCache") os
+ * dB são guardados em 8 bits com passo de
+ * SpectrogramCalculator::QuantizationStepDb, um quarto da memória dos
+ * valores em float; tile() os converte de volta e tileLevels() os entrega
+ * como estão (imagens do widget).
+ *
+ * Tiles inseridos pelo pré-cálculo (SpectrogramPrefetcher) são contados à
+ * parte enquanto estiverem no cache e ainda não tiverem sido lidos por
+ * tile(): prefetchedBytes() é a memória que o pré-cálculo ocupa de fato,
+ * já descontados os tiles descartados pelo LRU.
+ */
+class SpectrogramCache
+{
+public:
+    struct Statistics {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 insertions = 0;
+        int entries = 0;
+        qint64 sizeBytes = 0;
+        qint64 maxSizeBytes = 0;
+    };
+
+    static SpectrogramCache& instance();
+
+    bool contains(const SpectrogramCacheKey &key) const;
+
+    /**
+     * @brief Há um tile completo (não uma prévia) para a chave
+     */
+    bool containsComplete(const SpectrogramCacheKey &key) const;
+
+    /**
+     * @brief Tile em cache (nulo se ausente); conta acerto ou falha
+     */
+    SpectrogramTile tile(const SpectrogramCacheKey &key);
+
+    /**
+     * @brief Tile em cache sem converter os níveis em dB; conta acerto ou
+     *        falha, como tile()
+     * @param levels Recebe os níveis de 8 bits coluna a coluna (cópia
+     *        compartilhada); vazio se o tile foi guardado em float
+     * @return Tile sem db no modo quantizado, com db caso contrário; nulo
+     *         se ausente
+     */
+    SpectrogramTile tileLevels(const SpectrogramCacheKey &key, QByteArray &levels);
+
+    /**
+     * @brief Tile em cache (nulo se ausente), sem contar nas estatísticas
+     *
+     * Para consultas internas (fontes do pooling): não conta acerto nem
+     * falha e não tira o tile da conta do pré-cálculo.
+     */
+    SpectrogramTile peek(const SpectrogramCacheKey &key) const;
+
+    /**
+     * @brief Valor em dB de uma célula de um tile em cache, sem contar nas
+     *        estatísticas (leitura sob o cursor)
+     * @return false se o tile ou a célula não existirem
+     */
+    bool levelAt(const SpectrogramCacheKey &key, int column, int bin, float &db) const;
+
+    /**
+     * @brief Insere um tile (substituindo o de mesma chave)
+     *
+     * Uma prévia (SpectrogramTile::preview) não substitui um tile completo.
+     * @param prefetched Tile do pré-cálculo: conta em prefetchedBytes()
+     */
+    void insert(const SpectrogramCacheKey &key, const SpectrogramTile &tile, bool prefetched = false);
+
+    /**
+     * @brief Bytes dos tiles pré-calculados ainda no cache e não lidos
+     */
+    qint64 prefetchedBytes() const;
+
+    /**
+     * @brief Remove todos os tiles de um arquivo
+     */
+    void removeFile(quint64 fileId);
+
+    void clear();
+
+    int maxSizeMB() const;
+    void setMaxSizeMB(int megabytes);
+
+    bool isQuantized() const;
+
+    /**
+     * @brief Ativa o armazenamento em 8 bits (vale para as próximas inserções)
+     */
+    void setQuantized(bool quantized);
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    SpectrogramCache();
+    SpectrogramCache(const SpectrogramCache&) = delete;
+    SpectrogramCache& operator=(const SpectrogramCache&) = delete;
+
+    // Tile guardado: dB em float, ou níveis de 8 bits (tile.db vazio).
+    // Entradas do pré-cálculo apontam para m_prefetchedBytes e se descontam
+    // dele ao sair do cache (o QCache as apaga sob m_mutex)
+    struct Entry {
+        SpectrogramTile tile;
+        QByteArray levels;
+        qint64 bytes = 0;
+        qint64 *prefetchedBytes = nullptr;
+
+        ~Entry() {
+            if (prefetchedBytes) {
+                *prefetchedBytes -= bytes;
+            }
+        }
+    };
+
+    mutable QMutex m_mutex;
+    qint64 m_prefetchedBytes;                       // Declarado antes de m_tiles, que o atualiza ao ser destruído
+    QCache<SpectrogramCacheKey, Entry> m_tiles;     // Custo em KB
+    bool m_quantized;
+    qint64 m_hits;
+    qint64 m_misses;
+    qint64 m_insertions;
+};
+
+#endif // SPECTROGRAMCACHE_H
@@ -2,78 +2,368 @@
 #define SPECTROGRAMCALCULATOR_H
 
 #include <QObject>
+#include <QByteArray>
 #include <QImage>
 #include <QVector>
+#include <QMutex>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <complex>
+#include "audio/FrequencyScale.h"
+#include "audio/SpectrogramTile.h"
 
 class AudioFile;
+class QThreadPool;
 
 /**
  * @brief Calculador de espectrograma em thread separada
- * 
- * Limita o cálculo a 20 segundos de áudio para evitar travamento
+ *
+ * O espectrograma do arquivo inteiro é dividido em tiles de TileFrames
+ * colunas alinhadas à grade de hop: o tile t cobre os frames
+ * [t * TileFrames, (t + 1) * TileFrames). Cada cálculo recebe a lista de
+ * tiles necessários e emite a matriz de dB de cada tile, de modo que a
+ * visualização calcula apenas o que está na janela visível. A conversão em
+ * imagem é separada e não depende das FFTs: quantize() grava os níveis em
+ * uma imagem de 8 bits e palette() dá a tabela de cores, de modo que mudar
+ * o mapa de cores ou a faixa dinâmica troca apenas 256 cores.
+ *
+ * Os tiles formam uma pirâmide: no nível L cada coluna resume 2^L frames
+ * da análise base (passo de tempo 2^L * timeStep). Um tile do nível L é
+ * obtido por pooling das colunas dos dois tiles do nível L - 1 quando eles
+ * são fornecidos; caso contrário cada coluna é o pooling das FFTs de todos
+ * os seus frames. Como isso custa uma FFT por frame do trecho, antes sai
+ * uma prévia (SpectrogramTile::preview) com no máximo MaxFramesPerColumn
+ * FFTs distribuídas em cada coluna, que a visualização mostra até o tile
+ * completo chegar; prévias não vão para os caches em disco nem servem de
+ * fonte para o pooling.
+ *
+ * As colunas são divididas em blocos e processadas em paralelo pelo
+ * pool global de threads (QtConcurrent).
+ *
+ * Na análise dupla (Parameters::secondaryTimeWindow > 0, por exemplo banda
+ * larga de 5 ms e banda estreita de 30 ms) as duas análises compartilham a
+ * decimação, o passo e os blocos de colunas: cada frame é lido uma única
+ * vez, com o tamanho da janela maior, e cada análise usa a sua parte
+ * centrada. Os tiles trazem o índice da análise (SpectrogramTile::analysis)
+ * e são iguais aos de uma análise simples com Parameters::analysis().
+ *
+ * Cada pedido recebe um número de geração. Um novo pedido torna obsoletos
+ * os anteriores: o cálculo em andamento para no próximo bloco e emite
+ * calculationCancelled, e um pedido ainda não iniciado é descartado. Todos
+ * os sinais trazem a geração, para que resultados atrasados possam ser
+ * reconhecidos.
  */
 class SpectrogramCalculator : public QObject
 {
     Q_OBJECT
 
 public:
+    enum PoolingMode {
+        MaxPooling,     // Preserva eventos curtos ao reduzir a resolução
+        MeanPooling
+    };
+
+    enum WindowType {
+        Hamming,
+        Hanning,
+        Blackman,
+        Rectangular
+    };
+
+    enum ColorMap {
+        Grayscale,
+        Jet,
+        Hot,
+        Cool,
+        Viridis
+    };
+
     struct Parameters {
         double timeStep = 0.005;        // 5 ms
         double timeWindow = 0.025;      // 25 ms
         int fftSize = 1024;
-        QString windowType = "Hamming";
+        WindowType windowType = Hamming;
         double minFrequency = 0.0;
         double maxFrequency = 8000.0;
-        double dynamicRange = 70.0;
-        QString colorMap = "Grayscale";
         bool preEmphasis = false;
         double preEmphasisFactor = 0.97;
-        double maxDuration = 20.0;      // Limite de 20 segundos
-        double startTime = 0.0;         // Tempo inicial da janela
-        double windowDuration = 0.0;    // Duração da janela (0 = usar maxDuration)
+        PoolingMode pooling = MaxPooling; // Combinação de colunas nos níveis > 0
+        double secondaryTimeWindow = 0.0; // > 0: análise dupla, segunda janela (s)
+
+        bool operator==(const Parameters &other) const {
+            return timeStep == other.timeStep && timeWindow == other.timeWindow &&
+                   fftSize == other.fftSize && windowType == other.windowType &&
+                   minFrequency == other.minFrequency && maxFrequency == other.maxFrequency &&
+                   preEmphasis == other.preEmphasis &&
+                   preEmphasisFactor == other.preEmphasisFactor && pooling == other.pooling &&
+                   secondaryTimeWindow == other.secondaryTimeWindow;
+        }
+        bool operator!=(const Parameters &other) const { return !(*this == other); }
+
+        int numAnalyses() const { return secondaryTimeWindow > 0.0 ? 2 : 1; }
+
+        /**
+         * @brief Parâmetros de uma única análise (0: timeWindow; 1:
+         *        secondaryTimeWindow), usados nas chaves dos caches
+         */
+        Parameters analysis(int index) const {
+            Parameters single = *this;
+            if (index == 1) {
+                single.timeWindow = secondaryTimeWindow;
+            }
+            single.secondaryTimeWindow = 0.0;
+            return single;
+        }
+    };
+
+    /**
+     * @brief Número de colunas (frames) por tile
+     */
+    static constexpr int TileFrames = 256;
+
+    /**
+     * @brief Máximo de FFTs por coluna na prévia de um nível sem os tiles finos
+     */
+    static constexpr int MaxFramesPerColumn = 4;
+
+    /**
+     * @brief Nível mais alto da pirâmide
+     */
+    static constexpr int MaxLevel = 20;
+
+    /**
+     * @brief Máximo de análises calculadas juntas (análise dupla)
+     */
+    static constexpr int MaxAnalyses = 2;
+
+    /**
+     * @brief Número de entradas das tabelas de cores
+     */
+    static constexpr int ColorTableSize = 1024;
+
+    /**
+     * @brief Níveis da representação quantizada (8 bits)
+     */
+    static constexpr int QuantizedLevels = 256;
+
+    /**
+     * @brief Passo da quantização em dB: o nível 255 é 0 dB e o nível 0,
+     *        -127,5 dB (ou menos)
+     */
+    static constexpr float QuantizationStepDb = 0.5f;
+
+    /**
+     * @brief Total de amostras de FFT (colunas * fftSize) de uma prévia
+     */
+    static constexpr int PreviewFftBudget = 1 << 19;
+
+    /**
+     * @brief Geometria da análise para um arquivo
+     *
+     * O frame f é centrado em (f + 0.5) * frameDuration segundos, de modo
+     * que a coluna f ocupa exatamente [f, f + 1) * frameDuration.
+     */
+    struct Geometry {
+        int sampleRate = 0;             // Taxa após a decimação
+        int downsampleFactor = 1;
+        int windowSize = 0;
+        int hopSize = 0;
+        int fftSize = 0;
+        int minBin = 0;
+        int maxBin = 0;                 // Exclusivo
+        int numFrames = 0;              // Frames do arquivo inteiro
+        double frameDuration = 0.0;     // Hop em segundos
+
+        bool isValid() const { return windowSize > 0 && hopSize > 0 && numFrames > 0; }
+        int numBins() const { return maxBin - minBin; }
+        int framesPerColumn(int level) const { return 1 << level; }
+        int numColumns(int level = 0) const {
+            return (numFrames + framesPerColumn(level) - 1) >> level;
+        }
+        int numTiles(int level = 0) const {
+            return (numColumns(level) + TileFrames - 1) / TileFrames;
+        }
+        double columnDuration(int level = 0) const { return frameDuration * framesPerColumn(level); }
+        double tileDuration(int level = 0) const { return TileFrames * columnDuration(level); }
+        int maxLevel() const {
+            int level = 0;
+            while (level < MaxLevel && numTiles(level) > 1) {
+                ++level;
+            }
+            return level;
+        }
     };
 
+    /**
+     * @brief Calcula a geometria da análise
+     * @param params Parâmetros do espectrograma
+     * @param sampleRate Taxa de amostragem original
+     * @param numSamples Número de amostras originais
+     */
+    static Geometry computeGeometry(const Parameters &params, int sampleRate, qint64 numSamples);
+
     explicit SpectrogramCalculator(QObject *parent = nullptr);
     ~SpectrogramCalculator();
-    
+
     /**
-     * @brief Calcula o espectrograma (executa em thread)
+     * @brief Pede o cálculo dos tiles indicados de um nível (executa em thread)
+     *
+     * Substitui qualquer pedido anterior ainda em andamento.
+     * @param audioFile Arquivo de áudio
+     * @param params Parâmetros do espectrograma
+     * @param level Nível da pirâmide
+     * @param tiles Índices dos tiles a calcular, em ordem de prioridade; cada
+     *              tile é emitido (tileReady) assim que fica pronto
+     * @param sources Tiles já calculados do nível level - 1, usados por pooling
+     * @return Geração do pedido (0 se inválido)
      */
-    void calculate(std::shared_ptr<AudioFile> audioFile, const Parameters &params);
-    
+    quint64 calculate(std::shared_ptr<AudioFile> audioFile, const Parameters &params,
+                   int level, const QVector<int> &tiles,
+                   const QVector<SpectrogramTile> &sources = QVector<SpectrogramTile>());
+
+    /**
+     * @brief Prévia de baixa resolução de um trecho (síncrono)
+     *
+     * Uma FFT por coluna, com passo grosso, lendo e decimando apenas as
+     * janelas dos frames calculados. O número de colunas é reduzido para
+     * FFTs grandes, de modo que o custo fica limitado (PreviewFftBudget
+     * amostras de FFT). A janela e a faixa de frequências são as de
+     * params, como no cálculo completo. Não usa caches.
+     * @param audioFile Arquivo de áudio
+     * @param params Parâmetros do espectrograma
+     * @param startTime Início do trecho (s)
+     * @param duration Duração do trecho (s)
+     * @param maxColumns Máximo de colunas (em geral, a largura da prévia)
+     * @param isCancelled Consultado a cada coluna; true interrompe o cálculo
+     * @return Tile com as colunas do trecho (nulo se cancelado, inválido ou se a
+     *         leitura do arquivo falhar)
+     */
+    static SpectrogramTile computePreview(const AudioFile &audioFile, const Parameters &params,
+                                          double startTime, double duration, int maxColumns,
+                                          const std::function<bool()> &isCancelled);
+
+    /**
+     * @brief Converte os dB de um tile em imagem Format_Indexed8 (frequências
+     *        baixas embaixo), sem tabela de cores (ver palette())
+     * @param tile Tile calculado
+     * @param remap Linhas da escala de frequência (nula: um bin por linha)
+     */
+    static QImage quantize(const SpectrogramTile &tile, const FrequencyRemap &remap = FrequencyRemap());
+
+    /**
+     * @brief Como quantize(), a partir de níveis já quantizados (ver
+     *        SpectrogramCache::tileLevels()), sem passar por dB
+     * @param tile Dimensões do tile
+     * @param levels Níveis coluna a coluna (numColumns x numBins)
+     * @param remap Linhas da escala de frequência (nula: um bin por linha)
+     */
+    static QImage quantize(const SpectrogramTile &tile, const QByteArray &levels,
+                           const FrequencyRemap &remap = FrequencyRemap());
+
+    /**
+     * @brief Tabela de cores (QuantizedLevels entradas) das imagens de quantize()
+     * @param dynamicRange Faixa dinâmica abaixo de 0 dB exibida
+     * @param colorMap Mapa de cores
+     */
+    static QVector<QRgb> palette(double dynamicRange, ColorMap colorMap);
+
+    /**
+     * @brief Nível quantizado de um valor em dB
+     */
+    static quint8 quantizeDb(float db);
+
+    /**
+     * @brief Valor em dB de um nível quantizado
+     */
+    static float dequantizeDb(quint8 level);
+
+    /**
+     * @brief Chave dos parâmetros de análise (cache em disco)
+     */
+    static QString parametersKey(const Parameters &params);
+
     /**
-     * @brief Cancela o cálculo em andamento
+     * @brief Coeficientes da janela de tamanho N (cache por tipo e tamanho)
+     */
+    static QVector<float> windowTable(WindowType windowType, int N);
+
+    /**
+     * @brief Tipo de janela pelo nome usado nas configurações ("Hamming", ...)
+     */
+    static WindowType windowTypeFromName(const QString &name);
+
+    /**
+     * @brief Mapa de cores pelo nome usado nas configurações ("Jet", ...)
+     */
+    static ColorMap colorMapFromName(const QString &name);
+
+    /**
+     * @brief Tabela de cores pré-calculada (ColorTableSize entradas, 0 -> 1)
+     */
+    static const QVector<QRgb> &colorTable(ColorMap colorMap);
+
+    /**
+     * @brief Pool de threads dos blocos de colunas (padrão: o pool global)
+     *
+     * Deve ser chamado antes do primeiro pedido.
+     */
+    void setThreadPool(QThreadPool *pool);
+
+    /**
+     * @brief Cancela o cálculo em andamento e os pedidos pendentes
      */
     void cancel();
-    
+
     /**
      * @brief Verifica se está calculando
      */
     bool isCalculating() const { return m_isCalculating; }
 
 signals:
-    void calculationStarted();
-    void calculationProgress(int percent);
-    void calculationFinished(QImage spectrogram);
-    void calculationError(QString error);
+    void calculationStarted(quint64 generation);
+    void calculationProgress(quint64 generation, int percent);
+    void tileReady(quint64 generation, SpectrogramTile tile);
+    void calculationFinished(quint64 generation);
+    void calculationCancelled(quint64 generation);
+    void calculationError(quint64 generation, QString error);
     void startCalculationInThread();  // Sinal interno para thread
 
 public slots:
     void performCalculation();
 
 private:
-    QVector<float> applyWindow(const QVector<float> &frame, const QString &windowType);
-    QVector<std::complex<float>> computeFFT(const QVector<float> &frame);
-    QColor valueToColor(float value, const QString &colorMap, float dynamicRange);
-    int nextPowerOfTwo(int n);
+    static QRgb valueToColor(float value, ColorMap colorMap);
+    static int nextPowerOfTwo(int n);
+    bool isObsolete(quint64 generation) const;
+    void finishRequest();
 
 private:
+    // Pedido aguardando a thread de cálculo
+    struct Request {
+        quint64 generation = 0;
+        std::shared_ptr<AudioFile> audioFile;
+        Parameters params;
+        int level = 0;
+        QVector<int> tiles;
+        QVector<SpectrogramTile> sources;
+    };
+
+    QThreadPool *m_threadPool;
+    
+    // Pedido em execução (acessado apenas pela thread de cálculo)
     std::shared_ptr<AudioFile> m_audioFile;
     Parameters m_params;
-    bool m_isCalculating;
-    bool m_cancelRequested;
+    int m_level;
+    QVector<int> m_tiles;
+    QVector<SpectrogramTile> m_sources;
+    
+    QMutex m_requestMutex;
+    Request m_pendingRequest;
+    std::atomic<quint64> m_generation;           // Última geração emitida
+    std::atomic<quint64> m_cancelledGeneration;  // Gerações <= canceladas
+    std::atomic<bool> m_isCalculating;
+    bool m_hasPendingRequest;
 };
 
 #endif // SPECTROGRAMCALCULATOR_H
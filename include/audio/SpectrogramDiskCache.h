@@ -0,0 +1,92 @@
+#ifndef SPECTROGRAMDISKCACHE_H
+#define SPECTROGRAMDISKCACHE_H
+
+#include <QString>
+#include <QMutex>
+#include <QSet>
+#include "audio/SpectrogramTile.h"
+
+/**
+ * @brief Cache persistente de tiles de espectrograma em disco
+ *
+ * Cada tile (matriz de dB) é gravado em
+ * <cache>/BionoteEchos/spectrogram/<conteúdo>/<parâmetros>/<nível>_<índice>.tile,
+ * onde <conteúdo> é a impressão digital do arquivo de áudio e <parâmetros>
+ * o hash dos parâmetros de análise. A leitura usa mapeamento em memória
+ * (QFile::map). Quando o tamanho total passa do limite, os arquivos usados
+ * há mais tempo são removidos.
+ *
+ * As impressões digitais ficam num índice em <cache>/.../fingerprints,
+ * por caminho canônico, tamanho e data de modificação do arquivo de áudio:
+ * reabrir um arquivo não exige lê-lo inteiro de novo.
+ *
+ * Seguro para uso a partir de várias threads.
+ */
+class SpectrogramDiskCache
+{
+public:
+    static SpectrogramDiskCache& instance();
+
+    /**
+     * @brief Impressão digital do conteúdo de um arquivo
+     *
+     * SHA-1 do tamanho e do conteúdo inteiro: não depende do caminho nem
+     * da data de modificação. Lê o arquivo todo; fingerprint() guarda o
+     * resultado no índice.
+     * @return Vazia se o arquivo não puder ser lido
+     */
+    static QString contentFingerprint(const QString &filePath);
+
+    /**
+     * @brief Impressão digital do conteúdo, sem bloquear
+     *
+     * Lida do índice enquanto o caminho canônico, o tamanho e a data de
+     * modificação do arquivo não mudarem. Caso contrário,
+     * contentFingerprint() é calculada em segundo plano e gravada no
+     * índice.
+     * @return Vazia enquanto a impressão digital é calculada (o cache em
+     *         disco fica de fora até lá)
+     */
+    QString fingerprint(const QString &filePath);
+
+    /**
+     * @brief Lê um tile do cache
+     * @return true se encontrado e válido
+     */
+    bool load(const QString &contentKey, const QString &parametersKey,
+              int level, int index, SpectrogramTile &tile);
+
+    /**
+     * @brief Grava um tile no cache (substitui o anterior)
+     */
+    void store(const QString &contentKey, const QString &parametersKey,
+               const SpectrogramTile &tile);
+
+    /**
+     * @brief Remove todos os tiles do cache
+     */
+    void clear();
+
+    QString cacheDirectory() const { return m_directory; }
+    qint64 maxSizeBytes() const { return m_maxSizeBytes; }
+    void setMaxSizeBytes(qint64 bytes);
+
+private:
+    SpectrogramDiskCache();
+    SpectrogramDiskCache(const SpectrogramDiskCache&) = delete;
+    SpectrogramDiskCache& operator=(const SpectrogramDiskCache&) = delete;
+
+    QString tilePath(const QString &contentKey, const QString &parametersKey,
+                     int level, int index) const;
+    QString fingerprintIndexPath(const QString &canonicalPath) const;
+    void ensureSizeKnownLocked();
+    void evictLocked();
+
+    QString m_directory;
+    qint64 m_maxSizeBytes;
+    qint64 m_totalBytes;            // -1 até a primeira varredura
+    QSet<QString> m_pendingFingerprints;    // Caminhos canônicos em cálculo
+    QMutex m_mutex;
+};
+
+#endif // SPECTROGRAMDISKCACHE_H
@@ -0,0 +1,99 @@
+#ifndef SPECTROGRAMPREFETCHER_H
+#define SPECTROGRAMPREFETCHER_H
+
+#include <QObject>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <memory>
+#include "audio/SpectrogramCalculator.h"
+
+class AudioFile;
+
+/**
+ * @brief Pré-cálculo em segundo plano do espectrograma de outros arquivos
+ *
+ * Ao selecionar um arquivo, calcula a primeira visualização (o arquivo
+ * inteiro, no nível da pirâmide que a largura do widget usa) dos vizinhos
+ * na lista do projeto e dos usados recentemente. Os tiles vão para o
+ * SpectrogramCache e para o cache em disco, de modo que abrir esses
+ * arquivos não espera pelas FFTs.
+ *
+ * Usa um calculador próprio, com pool de threads e thread de controle em
+ * prioridade ociosa (no Linux, SCHED_IDLE também coloca a E/S na classe
+ * ociosa), e espera enquanto um cálculo interativo está em andamento.
+ * Pode ser pausado, e para enquanto os tiles pré-calculados ainda no
+ * cache ocupam o teto de memória (QSettings "spectrogram/prefetchMB"); a
+ * memória volta a ficar disponível quando o LRU os descarta ou quando a
+ * visualização passa a usá-los.
+ */
+class SpectrogramPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrogramPrefetcher(QObject *parent = nullptr);
+    ~SpectrogramPrefetcher();
+
+    /**
+     * @brief Parâmetros de análise e largura (pixels) da visualização
+     */
+    void setViewport(const SpectrogramCalculator::Parameters &params, int width);
+
+    bool isPaused() const { return m_paused; }
+    qint64 memoryCeilingBytes() const { return m_maxBytes; }
+    void setMemoryCeilingBytes(qint64 bytes);
+
+    /**
+     * @brief Memória dos tiles pré-calculados ainda no cache (limitada pelo teto)
+     */
+    qint64 prefetchedBytes() const;
+
+public slots:
+    /**
+     * @brief Arquivo selecionado: enfileira vizinhos e recentes
+     * @param audioFile Arquivo selecionado (não é pré-calculado)
+     * @param projectFiles Arquivos do projeto, na ordem da lista
+     */
+    void fileSelected(std::shared_ptr<AudioFile> audioFile,
+                      const QVector<std::shared_ptr<AudioFile>> &projectFiles);
+
+    void setPaused(bool paused);
+
+    /**
+     * @brief Cálculo interativo em andamento: o pré-cálculo espera
+     */
+    void setForegroundActive(bool active);
+
+private slots:
+    void onTileReady(quint64 generation, SpectrogramTile tile);
+    void onCalculationDone(quint64 generation);
+
+private:
+    void startNext();
+    void stopCurrent();
+    int levelForFile(const SpectrogramCalculator::Geometry &geometry) const;
+
+private:
+    QThread *m_calculatorThread;
+    SpectrogramCalculator *m_calculator;
+    QThreadPool m_threadPool;
+
+    SpectrogramCalculator::Parameters m_params;
+    int m_width;
+
+    QVector<std::weak_ptr<AudioFile>> m_queue;
+    QVector<std::weak_ptr<AudioFile>> m_recentFiles;   // Mais recente primeiro
+
+    // Pedido em andamento
+    std::weak_ptr<AudioFile> m_currentFile;
+    SpectrogramCalculator::Parameters m_currentParams;
+    quint64 m_currentGeneration;
+    bool m_isCalculating;
+
+    bool m_paused;
+    bool m_foregroundActive;
+    qint64 m_maxBytes;
+};
+
+#endif // SPECTROGRAMPREFETCHER_H
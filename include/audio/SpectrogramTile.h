@@ -0,0 +1,44 @@
+#ifndef SPECTROGRAMTILE_H
+#define SPECTROGRAMTILE_H
+
+#include <QVector>
+#include <QMetaType>
+
+/**
+ * @brief Bloco de colunas do espectrograma em um nível da pirâmide
+ *
+ * No nível L cada coluna resume 2^L frames da análise base; o tile
+ * `index` cobre as colunas [index * TileFrames, (index + 1) * TileFrames)
+ * desse nível (ver SpectrogramCalculator::Geometry).
+ *
+ * Guarda apenas os valores em dB (relativos ao fundo de escala); a
+ * colorização é feita à parte, de modo que mudar o mapa de cores ou a
+ * faixa dinâmica não exige recalcular as FFTs.
+ */
+struct SpectrogramTile {
+    int level = 0;
+    int index = 0;
+    int analysis = 0;       // Análise dupla: 0 = janela principal, 1 = secundária
+    int numColumns = 0;
+    int numBins = 0;
+    QVector<float> db;      // numColumns x numBins, coluna a coluna
+    float minDb = 0.0f;     // Menor e maior valor dos frames analisados,
+    float maxDb = 0.0f;     // para normalização
+    bool preview = false;   // Prévia (amostra dos frames de cada coluna), substituída pelo tile completo
+
+    bool isNull() const { return numColumns == 0; }
+    const float* column(int c) const { return db.constData() + c * numBins; }
+    float value(int c, int bin) const { return db[c * numBins + bin]; }
+};
+
+Q_DECLARE_METATYPE(SpectrogramTile)
+
+/**
+ * @brief Chave única de um tile (nível, índice) para caches
+ */
+inline quint64 spectrogramTileKey(int level, int index)
+{
+    return (static_cast<quint64>(level) << 32) | static_cast<quint32>(index);
+}
+
+#endif // SPECTROGRAMTILE_H
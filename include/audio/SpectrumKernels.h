@@ -0,0 +1,60 @@
+#ifndef SPECTRUMKERNELS_H
+#define SPECTRUMKERNELS_H
+
+#include <complex>
+
+/**
+ * @brief Núcleos vetorizados do caminho quente do espectrograma
+ *
+ * A implementação (AVX2, SSE2 ou escalar) é escolhida uma única vez em
+ * tempo de execução, conforme a CPU.
+ */
+namespace SpectrumKernels {
+
+    /**
+     * @brief Menor potência considerada (-200 dB), evita log(0)
+     */
+    constexpr float MinPower = 1e-20f;
+
+    /**
+     * @brief Erro máximo de powerToDb em relação a 10 * log10 (dB)
+     */
+    constexpr float MaxErrorDb = 1e-4f;
+
+    /**
+     * @brief Converte bins complexos em dB: 10 * log10(|X|^2) - referenceDb
+     *
+     * Usa uma aproximação polinomial do log2 (erro < MaxErrorDb) e
+     * acompanha o menor e o maior valor produzidos na mesma passada.
+     * @param spectrum Bins complexos
+     * @param count Número de bins
+     * @param referenceDb Valor subtraído de cada resultado
+     * @param dbOut Destino (count valores)
+     * @param minDb Atualizado com o menor valor (não é reiniciado)
+     * @param maxDb Atualizado com o maior valor (não é reiniciado)
+     */
+    void powerToDb(const std::complex<float> *spectrum, int count, float referenceDb,
+                   float *dbOut, float &minDb, float &maxDb);
+
+    /**
+     * @brief Implementação de referência (std::log10), para comparação
+     */
+    void powerToDbReference(const std::complex<float> *spectrum, int count, float referenceDb,
+                            float *dbOut, float &minDb, float &maxDb);
+
+    /**
+     * @brief Nome da implementação selecionada ("avx2", "sse2" ou "scalar")
+     */
+    const char *implementationName();
+
+    /**
+     * @brief Força uma implementação ("avx2", "sse2" ou "scalar"), para testes
+     *
+     * Não deve ser chamada com cálculos em andamento.
+     * @return false se o nome é desconhecido ou a CPU não a suporta (a
+     *         seleção atual é mantida)
+     */
+    bool setImplementation(const char *name);
+}
+
+#endif // SPECTRUMKERNELS_H
@@ -0,0 +1,90 @@
+#ifndef WAVEFORMSUMMARY_H
+#define WAVEFORMSUMMARY_H
+
+#include <QVector>
+
+/**
+ * @brief Pirâmide de resumo (mínimo, máximo e RMS) de um canal de áudio
+ *
+ * Guarda blocos de 256, 4096 e 65536 amostras. É montada em fluxo durante a
+ * decodificação (append() por blocos de leitura, finish() no fim); cada
+ * nível é alimentado pelo nível abaixo, de modo que cada amostra é lida uma
+ * única vez. Com ela o desenho da forma de onda custa O(largura em pixels)
+ * em qualquer zoom, em vez de percorrer todas as amostras visíveis.
+ */
+class WaveformSummary
+{
+public:
+    static const int NumLevels = 3;
+
+    struct Block {
+        float min = 0.0f;
+        float max = 0.0f;
+        float rms = 0.0f;
+    };
+
+    WaveformSummary();
+
+    /**
+     * @brief Tamanho do bloco (em amostras) de um nível
+     */
+    static int blockSize(int level);
+
+    /**
+     * @brief Acrescenta amostras ao fim do sinal resumido
+     */
+    void append(const float *samples, int count);
+
+    /**
+     * @brief Fecha os blocos incompletos do fim do sinal
+     *
+     * Chamado uma vez, depois da última chamada a append().
+     */
+    void finish();
+
+    qint64 numSamples() const { return m_numSamples; }
+    bool isEmpty() const { return m_numSamples == 0; }
+
+    const QVector<Block>& level(int level) const { return m_levels[level]; }
+
+    /**
+     * @brief Nível mais grosso com blocos de até samplesPerPixel amostras
+     * @return Índice do nível, ou -1 se nenhum bloco couber em um pixel
+     */
+    static int levelFor(double samplesPerPixel);
+
+    /**
+     * @brief Resumo do intervalo [startSample, endSample) em um nível
+     *
+     * Combina os blocos que tocam o intervalo (arredondado para fora, até
+     * um bloco a mais de cada lado).
+     */
+    Block range(int level, qint64 startSample, qint64 endSample) const;
+
+    /**
+     * @brief Resumo do sinal inteiro em numBins intervalos iguais
+     *
+     * Usa o nível mais grosso com pelo menos numBins blocos, de modo que o
+     * custo é limitado pelo número de blocos desse nível. Sinais com menos
+     * de numBins blocos no nível mais fino têm um intervalo por bloco.
+     */
+    QVector<Block> overview(int numBins) const;
+
+private:
+    // Bloco em formação de um nível
+    struct Accumulator {
+        float min = 0.0f;
+        float max = 0.0f;
+        double sumSquares = 0.0;
+        qint64 count = 0;       // Amostras cobertas
+    };
+
+    void addToLevel(int level, const Block &block, qint64 count);
+    void closeBlock(int level);
+
+    QVector<Block> m_levels[NumLevels];
+    Accumulator m_accumulators[NumLevels];
+    qint64 m_numSamples;
+};
+
+#endif // WAVEFORMSUMMARY_H
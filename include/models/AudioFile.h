@@ -4,9 +4,13 @@
 #include <QObject>
 #include <QString>
 #include <QVector>
-#include <QImage>
+#include <QHash>
+#include <QMutex>
+#include <QDateTime>
 #include <memory>
 
+class WaveformSummary;
+
 /**
  * @brief Representa um arquivo de áudio com seus metadados e dados de amostra
  * 
@@ -40,6 +44,7 @@ public:
     ~AudioFile();
 
     // Getters
+    quint64 getId() const { return m_id; }  // Único na execução (chave de caches)
     QString getFilePath() const { return m_filePath; }
     QString getFileName() const;
     int getSampleRate() const { return m_sampleRate; }
@@ -53,6 +58,38 @@ public:
     const QVector<float>& getSamples(int channel = 0) const;
     QVector<float> getMixedSamples() const;
     
+    /**
+     * @brief Amostras decimadas com filtro anti-aliasing (ver Decimator)
+     *
+     * O resultado é calculado uma vez por (canal, fator) e compartilhado
+     * entre espectrograma, pitch e intensidade. Seguro entre threads.
+     * @param factor Fator de decimação
+     * @param channel Canal
+     */
+    QVector<float> getDecimatedSamples(int factor, int channel = 0) const;
+    
+    /**
+     * @brief Pirâmide min/max/RMS de um canal (ver WaveformSummary)
+     * @return Resumo montado na decodificação, ou nulo se não houver
+     */
+    std::shared_ptr<const WaveformSummary> getWaveformSummary(int channel = 0) const;
+    
+    /**
+     * @brief Pirâmide do mid ((c0 + c1) / 2) ou do side ((c0 - c1) / 2)
+     * dos dois primeiros canais
+     * @param side false para mid, true para side
+     */
+    std::shared_ptr<const WaveformSummary> getMidSideSummary(bool side) const;
+    
+    /**
+     * @brief Impressão digital do conteúdo do arquivo
+     *
+     * Vem do índice do cache em disco (SpectrogramDiskCache::fingerprint())
+     * e é refeita apenas se o tamanho ou a data de modificação do arquivo
+     * mudarem. Vazia enquanto é calculada em segundo plano.
+     */
+    QString getContentKey() const;
+    
     bool isLoaded() const { return m_loaded; }
     bool hasPitchData() const { return m_hasPitchData; }
     bool hasIntensityData() const { return m_hasIntensityData; }
@@ -71,23 +108,12 @@ public:
     void setFileSize(qint64 fileSize) { m_fileSize = fileSize; }
     
     void setSamples(int channel, const QVector<float> &samples);
+    void setWaveformSummary(int channel, std::shared_ptr<const WaveformSummary> summary);
+    void setMidSideSummaries(std::shared_ptr<const WaveformSummary> mid,
+                             std::shared_ptr<const WaveformSummary> side);
     void setPitchData(const QVector<float> &pitchData);
     void setIntensityData(const QVector<float> &intensityData);
     
-    // Spectrogram cache
-    bool hasSpectrogramCache(const QString &settingsHash) const { 
-        return !m_spectrogramCache.isNull() && m_spectrogramCacheHash == settingsHash; 
-    }
-    QImage getSpectrogramCache() const { return m_spectrogramCache; }
-    void setSpectrogramCache(const QImage &spectrogram, const QString &settingsHash) { 
-        m_spectrogramCache = spectrogram; 
-        m_spectrogramCacheHash = settingsHash;
-    }
-    void clearSpectrogramCache() { 
-        m_spectrogramCache = QImage(); 
-        m_spectrogramCacheHash.clear();
-    }
-    
     /**
      * @brief Carrega o arquivo de áudio
      * @return true se carregado com sucesso, false caso contrário
@@ -143,6 +169,7 @@ signals:
     void intensityDataCalculated();
 
 private:
+    quint64 m_id;
     QString m_filePath;
     int m_sampleRate;
     int m_numChannels;
@@ -154,6 +181,8 @@ private:
     
     bool m_loaded;
     QVector<QVector<float>> m_channelSamples;
+    QVector<std::shared_ptr<const WaveformSummary>> m_waveformSummaries;
+    std::shared_ptr<const WaveformSummary> m_midSideSummaries[2];
     
     bool m_hasPitchData;
     QVector<float> m_pitchData;
@@ -161,9 +190,17 @@ private:
     bool m_hasIntensityData;
     QVector<float> m_intensityData;
     
-    // Spectrogram cache
-    QImage m_spectrogramCache;
-    QString m_spectrogramCacheHash;
+    // Sinais decimados por (canal, fator)
+    mutable QMutex m_decimatedMutex;
+    mutable QHash<quint64, QVector<float>> m_decimatedSamples;
+    
+    // Impressão digital do conteúdo (cache em disco), com o tamanho e a
+    // data de modificação do arquivo quando foi calculada
+    mutable QMutex m_contentKeyMutex;
+    mutable QString m_contentKey;
+    mutable qint64 m_contentKeySize;
+    mutable QDateTime m_contentKeyModified;
+    
 };
 
 #endif // AUDIOFILE_H
@@ -0,0 +1,119 @@
+#ifndef AUDIOOVERVIEWWIDGET_H
+#define AUDIOOVERVIEWWIDGET_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QImage>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include "audio/SpectrogramCalculator.h"
+#include "audio/WaveformSummary.h"
+
+class AudioFile;
+
+/**
+ * @brief Faixa de visão geral do arquivo inteiro, com o trecho visível
+ *
+ * Desenha a forma de onda do arquivo inteiro a partir de um resumo
+ * min/max de tamanho fixo (ver WaveformSummary::overview()) e,
+ * opcionalmente, uma miniatura do espectrograma (uma FFT por coluna, ver
+ * SpectrogramCalculator::computePreview()). Ambos custam o mesmo em
+ * qualquer duração de arquivo e ficam numa imagem refeita apenas quando o
+ * arquivo, o tamanho ou a miniatura mudam; o retângulo do trecho visível é
+ * desenhado por cima.
+ *
+ * Clicar posiciona o trecho visível no ponto clicado; arrastar o retângulo
+ * o desloca.
+ */
+class AudioOverviewWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit AudioOverviewWidget(QWidget *parent = nullptr);
+    ~AudioOverviewWidget();
+
+    void setAudioFile(std::shared_ptr<AudioFile> audioFile);
+
+    /**
+     * @brief Trecho visível nas demais visualizações
+     */
+    void setVisibleTimeRange(double startTime, double duration);
+
+    /**
+     * @brief Parâmetros e cores da miniatura do espectrograma
+     * @param params Parâmetros de análise (usada a janela principal)
+     * @param dynamicRange Faixa dinâmica (dB)
+     * @param colorMap Nome do mapa de cores
+     * @param frequencyScale Nome da escala de frequência
+     */
+    void setSpectrogramSettings(const SpectrogramCalculator::Parameters &params, double dynamicRange,
+                                const QString &colorMap, const QString &frequencyScale);
+
+    bool isShowingSpectrogram() const { return m_showSpectrogram; }
+
+public slots:
+    void setShowSpectrogram(bool show);
+
+signals:
+    /**
+     * @brief Sinal emitido quando o usuário move o trecho visível
+     */
+    void visibleTimeRangeChanged(double startTime, double duration);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void invalidateOverview();
+    void onThumbnailFinished();
+
+private:
+    void rebuildSummary();
+    void requestThumbnail();
+    void startThumbnail();
+    void updateThumbnailImage();
+    void drawOverview(QPainter &painter);
+    void moveViewportTo(double startTime);
+
+    QRect plotArea() const;
+    QRect viewportRect(double startTime, double duration) const;
+    double pixelToTime(int x) const;
+
+private:
+    std::shared_ptr<AudioFile> m_audioFile;
+    double m_viewStartTime;
+    double m_viewDuration;
+
+    // Resumo do arquivo inteiro (todos os canais), de tamanho fixo
+    QVector<WaveformSummary::Block> m_summary;
+
+    // Forma de onda e miniatura já desenhadas no tamanho do widget
+    QPixmap m_pixmap;
+    bool m_pixmapValid;
+
+    // Miniatura do espectrograma
+    bool m_showSpectrogram;
+    SpectrogramCalculator::Parameters m_params;
+    double m_dynamicRange;
+    QString m_colorMap;
+    QString m_frequencyScale;
+    QFutureWatcher<SpectrogramTile> m_thumbnailWatcher;
+    std::atomic<quint64> m_thumbnailGeneration;     // Miniaturas anteriores ficam obsoletas
+    bool m_thumbnailPending;                        // Pedido à espera da miniatura em andamento
+    quint64 m_runningGeneration;
+    SpectrogramTile m_thumbnailTile;
+    SpectrogramCalculator::Parameters m_thumbnailParams;
+    QImage m_thumbnail;
+
+    // Arrasto do retângulo: distância (s) do clique ao início do trecho
+    bool m_isDragging;
+    double m_dragOffset;
+};
+
+#endif // AUDIOOVERVIEWWIDGET_H
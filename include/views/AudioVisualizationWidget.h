@@ -5,18 +5,22 @@
 #include <QPainter>
 #include <QMouseEvent>
 #include <QWheelEvent>
+#include <QPixmap>
 #include <memory>
 
 class AudioFile;
 class SpectrogramWidget;
+class WaveformSummary;
 
 /**
  * @brief Widget para visualização interativa de forma de onda e espectrograma
  * 
  * Funcionalidades:
- * - Visualização de forma de onda (waveform)
+ * - Visualização de forma de onda (waveform), uma faixa por canal e,
+ *   opcionalmente, mid/side dos dois primeiros canais
  * - Visualização de espectrograma sincronizado
- * - Zoom horizontal (roda do mouse)
+ * - Zoom horizontal (roda do mouse); com menos de 2 amostras por pixel, a
+ *   forma de onda é reconstruída por interpolação sinc e as amostras marcadas
  * - Navegação temporal (arrastar)
  * - Seleção de trechos
  * - Labels de início e fim do trecho visualizado
@@ -128,6 +132,22 @@ public:
      * @return Tempo em segundos
      */
     double getPlaybackPosition() const { return m_playbackPosition; }
+    
+    /**
+     * @brief Mostra ou oculta a faixa de um canal
+     *
+     * Apenas redesenha: as faixas usam as pirâmides já calculadas.
+     * @param channel Canal (0 = primeiro)
+     * @param visible true para exibir
+     */
+    void setChannelVisible(int channel, bool visible);
+    bool isChannelVisible(int channel) const;
+    
+    /**
+     * @brief Mostra ou oculta as faixas mid/side dos dois primeiros canais
+     */
+    void setMidSideVisible(bool visible);
+    bool isMidSideVisible() const { return m_showMidSide; }
 
 signals:
     /**
@@ -158,23 +178,62 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
     void enterEvent(QEnterEvent *event) override;
     void leaveEvent(QEvent *event) override;
 
+private slots:
+    /**
+     * @brief Descarta a imagem das camadas estáticas e repinta o widget
+     */
+    void invalidateWaveform();
+
 private:
+    // Faixa da forma de onda: um canal, ou mid/side de um par de canais
+    struct WaveformLane {
+        QString name;
+        int firstChannel = 0;
+        int secondChannel = -1;                     // Apenas mid/side
+        const QVector<float> *first = nullptr;
+        const QVector<float> *second = nullptr;
+        int offset = 0;                             // Amostra de first[0] (trecho lido em fluxo)
+        int numSamples = 0;                         // Amostras do sinal inteiro
+        float sideSign = 1.0f;                      // +1: mid, -1: side
+        std::shared_ptr<const WaveformSummary> summary;
+        
+        float sample(int i) const;
+    };
+    
+    QVector<WaveformLane> visibleLanes() const;
+    
+    /**
+     * @brief Lê do arquivo as amostras [start, start + count) de um canal
+     *
+     * Usado quando o arquivo foi aberto em fluxo (sem amostras na memória).
+     */
+    bool readStreamWindow(int channel, int start, int count, QVector<float> &samples) const;
+    QVector<QRect> laneAreas(int numLanes) const;
+    
+    void drawStaticLayers(QPainter &painter);
+    void drawWindowInfo(QPainter &painter);
     void drawWaveform(QPainter &painter);
-    void drawWaveformDirect(QPainter &painter, const QVector<float>& samples,
-                           int startSample, int endSample,
-                           int leftMargin, int topMargin, int waveHeight, int centerY);
-    void drawWaveformDownsampled(QPainter &painter, const QVector<float>& samples,
-                                 int startSample, int endSample,
-                                 int leftMargin, int topMargin, int waveHeight, int centerY);
+    void drawWaveformDirect(QPainter &painter, const WaveformLane &lane,
+                            int startSample, int endSample, const QRect &area);
+    void drawWaveformDownsampled(QPainter &painter, const WaveformLane &lane,
+                                 int startSample, int endSample, const QRect &area);
     void drawAmplitudeAxis(QPainter &painter);
     void drawTimeLabels(QPainter &painter);
     void drawSelection(QPainter &painter);
     void drawPlaybackCursor(QPainter &painter);
     void drawMouseCursor(QPainter &painter);
     
+    QRect windowInfoRect() const;
+    int playbackCursorX() const;
+    QRect playbackCursorRect(int x) const;
+    QRect mouseCursorRect(int x) const;
+    void updatePlaybackCursor();
+    void updateMouseCursor(const QPoint &previousPos);
+    
     double pixelToTime(int pixel) const;
     int timeToPixel(double time) const;
     
@@ -191,6 +250,10 @@ private:
     double m_spectrogramZoomThreshold;
     bool m_showSpectrogram;
     
+    // Faixas da forma de onda
+    QVector<bool> m_channelVisible;
+    bool m_showMidSide;
+    
     // Selection
     bool m_hasSelection;
     double m_selectionStart;
@@ -200,6 +263,7 @@ private:
     double m_playbackPosition;
     bool m_isPlaying;
     class QTimer *m_updateTimer;
+    int m_playbackCursorX;          // Posição já pedida ao repintar (-1: oculto)
     
     // Mouse interaction
     bool m_isDragging;
@@ -209,6 +273,11 @@ private:
     bool m_mouseInWidget;
     QPoint m_currentMousePos;
     
+    // Cabeçalho, eixos, forma de onda e seleção já desenhados no tamanho
+    // do widget
+    QPixmap m_pixmap;
+    bool m_pixmapValid;
+    
     // Layout
     int m_waveformHeight;
     int m_spectrogramHeight;
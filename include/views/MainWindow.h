@@ -7,6 +7,7 @@
 
 class AudioListWidget;
 class AudioVisualizationWidget;
+class AudioOverviewWidget;
 class AnnotationLayerWidget;
 class AudioControlWidget;
 class ProjectController;
@@ -104,6 +105,7 @@ private slots:
 
 private:
     void createActions();
+    void updateOverviewSpectrogram();
     void createMenus();
     void createToolBars();
     void createStatusBar();
@@ -121,6 +123,7 @@ private:
     QSplitter *m_centralSplitter;
     AudioListWidget *m_audioListWidget;
     AudioVisualizationWidget *m_audioVisualizationWidget;
+    AudioOverviewWidget *m_audioOverviewWidget;
     class SpectrogramWidget *m_spectrogramWidget;
     AnnotationLayerWidget *m_annotationLayerWidget;
     AudioControlWidget *m_audioControlWidget;
@@ -133,6 +136,7 @@ private:
     
     // Audio player
     class CustomAudioPlayer *m_audioPlayer;
+    class SpectrogramPrefetcher *m_spectrogramPrefetcher;
     
     // Menus
     QMenu *m_fileMenu;
@@ -165,6 +169,9 @@ private:
     // View menu actions
     QAction *m_showSpectrogramAction;
     QAction *m_spectrogramSettingsAction;
+    QAction *m_toggleDualAnalysisAction;
+    QAction *m_prefetchSpectrogramsAction;
+    QAction *m_overviewSpectrogramAction;
     QAction *m_zoomInAction;
     QAction *m_zoomOutAction;
     QAction *m_zoomFitAction;
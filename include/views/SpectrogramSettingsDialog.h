@@ -2,7 +2,12 @@
 #define SPECTROGRAMSETTINGSDIALOG_H
 
 #include <QDialog>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include "audio/SpectrogramCalculator.h"
 
+class AudioFile;
 class QDoubleSpinBox;
 class QSpinBox;
 class QComboBox;
@@ -12,6 +17,11 @@ class QLabel;
 
 /**
  * @brief Diálogo para configuração do espectrograma
+ *
+ * Com um arquivo de áudio (setPreviewSource), mostra uma prévia de baixa
+ * resolução do trecho visível, recalculada em segundo plano a cada
+ * mudança; uma prévia em andamento é interrompida pela seguinte. O cálculo
+ * completo só acontece quando as configurações são aplicadas (OK).
  */
 class SpectrogramSettingsDialog : public QDialog
 {
@@ -22,6 +32,7 @@ public:
         // Parâmetros de cálculo
         double timeStep;          // Passo de tempo (s)
         double timeWindow;        // Janela de tempo (s)
+        double secondaryTimeWindow; // Segunda janela da análise dupla (s; 0 = desligada)
         int fftSize;              // Tamanho da FFT
         QString windowType;       // Tipo de janela (Hamming, Hanning, etc.)
         
@@ -30,6 +41,8 @@ public:
         double maxFrequency;      // Frequência máxima (Hz)
         double dynamicRange;      // Faixa dinâmica (dB)
         QString colorMap;         // Mapa de cores
+        QString frequencyScale;   // Eixo de frequência (Linear, Log, Bark, ERB)
+        QString dualDisplay;      // Análise dupla: Primary, Secondary ou Stacked
         bool preEmphasis;         // Pré-ênfase
         double preEmphasisFactor; // Fator de pré-ênfase
     };
@@ -39,19 +52,32 @@ public:
     
     Settings getSettings() const;
 
+    /**
+     * @brief Arquivo e trecho (s) mostrados na prévia
+     */
+    void setPreviewSource(std::shared_ptr<AudioFile> audioFile, double startTime, double duration);
+
 private slots:
     void onRestoreDefaults();
     void updatePreEmphasisState(int state);
+    void onSettingsChanged();
+    void onPreviewFinished();
 
 private:
     void setupUI();
     void loadSettings(const Settings &settings);
     Settings getDefaultSettings() const;
+    SpectrogramCalculator::Parameters calculatorParameters() const;
+    void requestPreview();
+    void startPreview();
+    void updatePreviewImage();
+    QImage previewImage(int analysis, int numRows, const Settings &settings) const;
 
 private:
     // Cálculo
     QDoubleSpinBox *m_timeStepSpinBox;
     QDoubleSpinBox *m_timeWindowSpinBox;
+    QDoubleSpinBox *m_secondaryTimeWindowSpinBox;
     QComboBox *m_fftSizeComboBox;
     QComboBox *m_windowTypeComboBox;
     
@@ -60,8 +86,23 @@ private:
     QDoubleSpinBox *m_maxFreqSpinBox;
     QDoubleSpinBox *m_dynamicRangeSpinBox;
     QComboBox *m_colorMapComboBox;
+    QComboBox *m_frequencyScaleComboBox;
+    QComboBox *m_dualDisplayComboBox;
     QCheckBox *m_preEmphasisCheckBox;
     QDoubleSpinBox *m_preEmphasisFactorSpinBox;
+    
+    // Prévia
+    QLabel *m_previewLabel;
+    std::shared_ptr<AudioFile> m_previewFile;
+    double m_previewStartTime;
+    double m_previewDuration;
+    QFutureWatcher<QVector<SpectrogramTile>> m_previewWatcher;
+    std::atomic<quint64> m_previewGeneration;   // Prévias anteriores ficam obsoletas
+    bool m_previewPending;                      // Pedido à espera da prévia em andamento
+    SpectrogramCalculator::Parameters m_requestedParams;
+    SpectrogramCalculator::Parameters m_runningParams;
+    QVector<SpectrogramTile> m_previewTiles;    // Última prévia concluída (uma por análise)
+    SpectrogramCalculator::Parameters m_previewTileParams;
 };
 
 #endif // SPECTROGRAMSETTINGSDIALOG_H
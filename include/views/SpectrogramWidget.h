@@ -3,14 +3,39 @@
 
 #include <QWidget>
 #include <QImage>
+#include <QPixmap>
+#include <QCache>
+#include <QHash>
 #include <QThread>
 #include <memory>
+#include "audio/SpectrogramCalculator.h"
+#include "audio/SpectrogramCache.h"
 
 class AudioFile;
-class SpectrogramCalculator;
 
 /**
  * @brief Widget para visualização de espectrograma
+ *
+ * O espectrograma é montado a partir de tiles (ver SpectrogramCalculator)
+ * guardados no cache LRU do AudioFile. Apenas os tiles da janela visível,
+ * mais uma margem, são calculados; ao navegar, somente os tiles novos
+ * são pedidos ao calculador.
+ *
+ * O nível da pirâmide é escolhido para ter cerca de uma coluna por pixel,
+ * de modo que o custo depende da largura do widget e não da duração
+ * visível. Enquanto um nível é calculado, os tiles dos níveis vizinhos já
+ * disponíveis são desenhados no lugar.
+ *
+ * O cache compartilhado (SpectrogramCache) guarda os dB de cada tile por
+ * arquivo e parâmetros de análise; as imagens ficam num cache próprio do
+ * widget, em 8 bits por célula (Format_Indexed8). Mudar o mapa de cores ou
+ * a faixa dinâmica troca apenas a tabela de 256 cores das imagens. A
+ * escala do eixo de frequência (linear, log, Bark, ERB) é aplicada ao
+ * gerar as imagens, por uma tabela de reamostragem dos bins; trocá-la não
+ * recalcula as FFTs.
+ *
+ * O desenho completo fica num QPixmap do tamanho do widget; durante a
+ * reprodução apenas as faixas sob o cursor são repintadas a partir dele.
  */
 class SpectrogramWidget : public QWidget
 {
@@ -21,6 +46,7 @@ public:
         // Parâmetros de cálculo
         double timeStep = 0.01;           // Passo de tempo (s) - 10ms
         double timeWindow = 0.03;         // Janela de tempo (s) - 30ms
+        double secondaryTimeWindow = 0.0; // > 0: análise dupla, segunda janela (s)
         int fftSize = 1024;               // Tamanho da FFT (será ajustado para potência de 2)
         QString windowType = "Hamming";   // Tipo de janela
         
@@ -29,6 +55,8 @@ public:
         double maxFrequency = 4000.0;     // Frequência máxima (Hz) - 4 kHz
         double dynamicRange = 90.0;       // Faixa dinâmica (dB)
         QString colorMap = "Grayscale";   // Mapa de cores
+        QString frequencyScale = "Linear"; // Eixo de frequência (Linear, Log, Bark, ERB)
+        QString dualDisplay = "Primary";  // Análise dupla: "Primary", "Secondary" ou "Stacked"
         bool preEmphasis = false;         // Pré-ênfase
         double preEmphasisFactor = 0.97;
     };
@@ -39,17 +67,39 @@ public:
     void setAudioFile(std::shared_ptr<AudioFile> audioFile);
     void setSettings(const Settings &settings);
     Settings getSettings() const { return m_settings; }
+    std::shared_ptr<AudioFile> getAudioFile() const { return m_audioFile; }
+    double getViewStartTime() const { return m_viewStartTime; }
+    double getViewDuration() const { return m_viewDuration; }
     void setPlaybackPosition(double timeSeconds);
     void setVisibleTimeRange(double startTime, double duration);
     void calculateSpectrogram();
+    
+    /**
+     * @brief Análise dupla: alterna entre a janela principal e a secundária
+     *
+     * As duas são calculadas juntas, de modo que a troca não recalcula.
+     */
+    void toggleDualAnalysis();
     bool isCalculating() const { return m_isCalculating; }
 
+    /**
+     * @brief Parâmetros de cálculo correspondentes às configurações atuais
+     */
+    SpectrogramCalculator::Parameters calculatorParameters() const;
+
+    /**
+     * @brief Largura (pixels) da área do espectrograma, sem as margens
+     */
+    int plotWidth() const;
+
 signals:
     void calculationStarted();
     void calculationProgress(int percent);
     void calculationFinished();
     void calculationError(QString error);
     void visibleTimeRangeChanged(double startTime, double duration);
+    void cursorValueChanged(double timeSeconds, double frequency, double db);
+    void calculatingChanged(bool calculating);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -57,29 +107,70 @@ protected:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
 private slots:
-    void onCalculationFinished(QImage spectrogram);
-    void onCalculationProgress(int percent);
-    void onCalculationError(QString error);
+    void onTileReady(quint64 generation, SpectrogramTile tile);
+    void onCalculationFinished(quint64 generation);
+    void onCalculationCancelled(quint64 generation);
+    void onCalculationProgress(quint64 generation, int percent);
+    void onCalculationError(quint64 generation, QString error);
 
 private:
+    void setCalculating(bool calculating);
+    SpectrogramCalculator::Geometry currentGeometry(int analysis = 0) const;
+    QVector<QPair<int, QRect>> analysisAreas() const;
+    int levelForView(const SpectrogramCalculator::Geometry &geometry) const;
+    bool visibleTileRange(const SpectrogramCalculator::Geometry &geometry, int level,
+                          int &firstTile, int &lastTile) const;
+    void requestVisibleTiles();
+    QImage tileImage(int level, int index, int analysis);
+    bool valueAt(const QPoint &pos, double &timeSeconds, double &frequency, double &db) const;
+    QVector<int> drawLevels(const SpectrogramCalculator::Geometry &geometry) const;
     void drawSpectrogram(QPainter &painter);
     void drawFrequencyAxis(QPainter &painter);
     void drawPlaybackCursor(QPainter &painter);
+    void invalidateSpectrogram();
+    int cursorX(double timeSeconds) const;
+    QRect cursorRect(int x) const;
     QColor valueToColor(float value) const;
-    QString getSettingsHash() const;
+    SpectrogramCacheKey tileKey(int level, int index, int analysis = 0) const;
+    FrequencyScale frequencyScale(const SpectrogramCalculator::Geometry &geometry) const;
+    const FrequencyRemap &frequencyRemap(int analysis);
 
 private:
     std::shared_ptr<AudioFile> m_audioFile;
     Settings m_settings;
-    QImage m_spectrogramImage;
     double m_viewStartTime;
     double m_viewDuration;
     double m_playbackPosition;
-    bool m_isCalculating;
+    bool m_isCalculating;          // Pedido mais recente ainda em andamento
     int m_calculationProgress;
     
+    // Pedidos enviados ao calculador, por geração, até terminarem
+    struct CalculationJob {
+        std::shared_ptr<AudioFile> audioFile;
+        SpectrogramCalculator::Parameters params;
+        int level = 0;
+        QVector<int> tiles;
+    };
+    QHash<quint64, CalculationJob> m_jobs;
+    quint64 m_currentGeneration;
+    
+    // Imagens quantizadas dos tiles do arquivo e parâmetros atuais (custo em
+    // KB) e a tabela de cores do mapa e faixa dinâmica atuais
+    QCache<quint64, QImage> m_tileImages;
+    QVector<QRgb> m_palette;
+    
+    // Linhas da escala de frequência de cada análise (nula na escala
+    // linear), refeitas quando as configurações ou o arquivo mudam
+    FrequencyRemap m_remaps[SpectrogramCalculator::MaxAnalyses];
+    bool m_remapValid;
+    
+    // Espectrograma e eixo já desenhados no tamanho do widget
+    QPixmap m_pixmap;
+    bool m_pixmapValid;
+    
     // Pan/drag control
     bool m_isDragging;
     int m_dragStartX;
@@ -220,6 +220,13 @@ else
     print_warning "FFTW3 not found by pkg-config"
 fi
 
+# Check FFTW3 (single precision)
+if pkg-config --exists fftw3f; then
+    print_success "FFTW3 (float) found: $(pkg-config --modversion fftw3f)"
+else
+    print_warning "FFTW3 (float) not found by pkg-config"
+fi
+
 # Check libsndfile
 if pkg-config --exists sndfile; then
     SNDFILE_VERSION=$(pkg-config --modversion sndfile)
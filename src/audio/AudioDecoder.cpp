@@ -1,9 +1,18 @@
 #include "audio/AudioDecoder.h"
+#include "audio/WaveformSummary.h"
 #include "models/AudioFile.h"
 #include <QFileInfo>
+#include <QSettings>
 #include <QDebug>
 #include <sndfile.h>
 
+namespace {
+    // Acima deste tamanho decodificado (MB) as amostras não são carregadas:
+    // o espectrograma, a forma de onda ampliada e a reprodução leem o
+    // arquivo em fluxo (AudioStreamReader)
+    const int kDefaultMaxDecodedMB = 2048;
+}
+
 AudioDecoder::AudioDecoder(QObject *parent) 
     : QObject(parent) 
 {
@@ -91,13 +100,38 @@ bool AudioDecoder::decode(const QString &filePath, std::shared_ptr<AudioFile> au
     }
     audioFile->setBitDepth(bitDepth);
     
+    // Arquivos longos: as amostras não ficam na memória (espectrograma e
+    // reprodução leem o arquivo em fluxo), mas a mesma passada de leitura
+    // ainda monta as pirâmides de resumo da forma de onda
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    qint64 maxDecodedBytes = static_cast<qint64>(
+        settings.value("audio/maxDecodedMB", kDefaultMaxDecodedMB).toInt()) * 1024 * 1024;
+    qint64 decodedBytes = static_cast<qint64>(sfInfo.frames) * sfInfo.channels * sizeof(float);
+    const bool keepSamples = maxDecodedBytes <= 0 || decodedBytes <= maxDecodedBytes;
+    
     // Ler amostras
     const int bufferSize = 8192;
     QVector<float> interleavedBuffer(bufferSize);
+    QVector<QVector<float>> blockBuffers(sfInfo.channels);
     QVector<QVector<float>> channelBuffers(sfInfo.channels);
     
+    // Pirâmides min/max/RMS, montadas à medida que os blocos são lidos
+    // (por canal e, com dois canais ou mais, mid/side dos dois primeiros)
+    QVector<std::shared_ptr<WaveformSummary>> summaries(sfInfo.channels);
+    std::shared_ptr<WaveformSummary> midSummary;
+    std::shared_ptr<WaveformSummary> sideSummary;
+    QVector<float> midBuffer;
+    QVector<float> sideBuffer;
+    if (sfInfo.channels >= 2) {
+        midSummary = std::make_shared<WaveformSummary>();
+        sideSummary = std::make_shared<WaveformSummary>();
+    }
+    
     for (int ch = 0; ch < sfInfo.channels; ++ch) {
-        channelBuffers[ch].reserve(sfInfo.frames);
+        if (keepSamples) {
+            channelBuffers[ch].reserve(sfInfo.frames);
+        }
+        summaries[ch] = std::make_shared<WaveformSummary>();
     }
     
     sf_count_t totalRead = 0;
@@ -106,10 +140,28 @@ bool AudioDecoder::decode(const QString &filePath, std::shared_ptr<AudioFile> au
     while ((framesRead = sf_readf_float(sndFile, interleavedBuffer.data(), 
                                          bufferSize / sfInfo.channels)) > 0) {
         // Desentrelaçar canais
-        for (sf_count_t frame = 0; frame < framesRead; ++frame) {
-            for (int ch = 0; ch < sfInfo.channels; ++ch) {
-                channelBuffers[ch].append(interleavedBuffer[frame * sfInfo.channels + ch]);
+        for (int ch = 0; ch < sfInfo.channels; ++ch) {
+            QVector<float> &block = blockBuffers[ch];
+            block.resize(framesRead);
+            for (sf_count_t frame = 0; frame < framesRead; ++frame) {
+                block[frame] = interleavedBuffer[frame * sfInfo.channels + ch];
             }
+            summaries[ch]->append(block.constData(), static_cast<int>(framesRead));
+            if (keepSamples) {
+                channelBuffers[ch].append(block);
+            }
+        }
+        if (midSummary) {
+            midBuffer.resize(framesRead);
+            sideBuffer.resize(framesRead);
+            const float *left = blockBuffers[0].constData();
+            const float *right = blockBuffers[1].constData();
+            for (sf_count_t frame = 0; frame < framesRead; ++frame) {
+                midBuffer[frame] = 0.5f * (left[frame] + right[frame]);
+                sideBuffer[frame] = 0.5f * (left[frame] - right[frame]);
+            }
+            midSummary->append(midBuffer.constData(), static_cast<int>(framesRead));
+            sideSummary->append(sideBuffer.constData(), static_cast<int>(framesRead));
         }
         
         totalRead += framesRead;
@@ -119,9 +171,18 @@ bool AudioDecoder::decode(const QString &filePath, std::shared_ptr<AudioFile> au
         emit decodingProgress(progress);
     }
     
-    // Armazenar amostras no AudioFile
+    // Armazenar amostras (se couberem no limite) e resumos no AudioFile
     for (int ch = 0; ch < sfInfo.channels; ++ch) {
-        audioFile->setSamples(ch, channelBuffers[ch]);
+        if (keepSamples) {
+            audioFile->setSamples(ch, channelBuffers[ch]);
+        }
+        summaries[ch]->finish();
+        audioFile->setWaveformSummary(ch, summaries[ch]);
+    }
+    if (midSummary) {
+        midSummary->finish();
+        sideSummary->finish();
+        audioFile->setMidSideSummaries(midSummary, sideSummary);
     }
     
     sf_close(sndFile);
@@ -129,7 +190,12 @@ bool AudioDecoder::decode(const QString &filePath, std::shared_ptr<AudioFile> au
     emit decodingProgress(100);
     emit decodingFinished(true);
     
-    qDebug() << "Arquivo decodificado:" << filePath;
+    if (keepSamples) {
+        qDebug() << "Arquivo decodificado:" << filePath;
+    } else {
+        qDebug() << "Arquivo aberto em fluxo (apenas resumos):" << filePath
+                 << "-" << decodedBytes / (1024 * 1024) << "MB decodificados";
+    }
     qDebug() << "  Canais:" << sfInfo.channels;
     qDebug() << "  Taxa de amostragem:" << sfInfo.samplerate << "Hz";
     qDebug() << "  Amostras:" << sfInfo.frames;
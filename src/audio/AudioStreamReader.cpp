@@ -0,0 +1,193 @@
+#include "audio/AudioStreamReader.h"
+#include <QObject>
+#include <algorithm>
+#include <cstring>
+#include <sndfile.h>
+
+namespace {
+    // Máximo de amostras (por canal) lidas do arquivo por vez
+    const int kBlockFrames = 16384;
+}
+
+AudioStreamReader::AudioStreamReader(const QString &filePath, int channel, int downsampleFactor,
+                                     int capacity)
+    : m_file(nullptr)
+    , m_channel(channel)
+    , m_numChannels(0)
+    , m_sampleRate(0)
+    , m_factor(std::max(1, downsampleFactor))
+    , m_inputFrames(0)
+    , m_numSamples(0)
+    , m_ringHead(0)
+    , m_bufferStart(0)
+    , m_bufferCount(0)
+    , m_inputPosition(0)
+    , m_warmup(0)
+{
+    SF_INFO sfInfo;
+    memset(&sfInfo, 0, sizeof(sfInfo));
+
+    m_file = sf_open(filePath.toUtf8().constData(), SFM_READ, &sfInfo);
+    if (!m_file) {
+        m_lastError = QObject::tr("Erro ao abrir arquivo: %1").arg(sf_strerror(nullptr));
+        return;
+    }
+
+    if (channel < 0 || channel >= sfInfo.channels) {
+        m_lastError = QObject::tr("Canal inválido: %1").arg(channel);
+        sf_close(m_file);
+        m_file = nullptr;
+        return;
+    }
+
+    m_numChannels = sfInfo.channels;
+    m_sampleRate = sfInfo.samplerate;
+    m_inputFrames = sfInfo.frames;
+    m_numSamples = (m_inputFrames + m_factor - 1) / m_factor;
+    m_ring.resize(std::max(1, capacity));
+
+    if (m_factor > 1) {
+        m_decimator = std::make_unique<Decimator>(m_factor);
+    }
+    seekTo(0);
+}
+
+AudioStreamReader::~AudioStreamReader()
+{
+    if (m_file) {
+        sf_close(m_file);
+    }
+}
+
+bool AudioStreamReader::read(qint64 start, int count, float *dst)
+{
+    std::fill(dst, dst + count, 0.0f);
+    if (!m_file) {
+        return false;
+    }
+    if (count > m_ring.size()) {
+        m_lastError = QObject::tr("Leitura maior que o buffer (%1 > %2)").arg(count).arg(m_ring.size());
+        return false;
+    }
+
+    const qint64 first = std::max<qint64>(0, start);
+    const qint64 last = std::min<qint64>(m_numSamples, start + count);
+    if (first >= last) {
+        return true;
+    }
+
+    // Avanço curto: reaproveitar o buffer e decodificar em sequência;
+    // recuo ou salto longo: reposicionar o arquivo
+    const qint64 bufferEnd = m_bufferStart + m_bufferCount;
+    if (first < m_bufferStart || first > bufferEnd + m_ring.size()) {
+        if (!seekTo(first)) {
+            return false;
+        }
+    }
+
+    // Descartar o que ficou antes de `first` (decodificando o intervalo,
+    // se houver, em pedaços do tamanho do buffer)
+    while (m_bufferStart + m_bufferCount < first) {
+        m_bufferStart += m_bufferCount;
+        m_bufferCount = 0;
+        m_ringHead = 0;
+        if (!fill(std::min<qint64>(first, m_bufferStart + m_ring.size()))) {
+            return false;
+        }
+    }
+    int drop = static_cast<int>(first - m_bufferStart);
+    m_ringHead = (m_ringHead + drop) % m_ring.size();
+    m_bufferStart = first;
+    m_bufferCount -= drop;
+
+    if (!fill(last)) {
+        return false;
+    }
+
+    // Copiar do buffer circular (no máximo duas partes)
+    const int size = m_ring.size();
+    const int n = static_cast<int>(last - first);
+    float *out = dst + (first - start);
+    int firstPart = std::min(n, size - m_ringHead);
+    std::copy(m_ring.constData() + m_ringHead, m_ring.constData() + m_ringHead + firstPart, out);
+    std::copy(m_ring.constData(), m_ring.constData() + (n - firstPart), out + firstPart);
+    return true;
+}
+
+bool AudioStreamReader::seekTo(qint64 start)
+{
+    qint64 inputStart = start * m_factor;
+    if (m_decimator) {
+        // A saída `start` é centrada na entrada start * factor: começar
+        // `delay` amostras antes, com o histórico do filtro cheio
+        int delay = m_decimator->delay();
+        inputStart = std::max<qint64>(0, start * m_factor - delay);
+        m_warmup = static_cast<int>(start * m_factor + delay - inputStart);
+        m_decimator->reset(m_warmup);
+    }
+
+    if (sf_seek(m_file, inputStart, SEEK_SET) < 0) {
+        m_lastError = QObject::tr("Erro ao posicionar o arquivo: %1").arg(sf_strerror(m_file));
+        return false;
+    }
+
+    m_inputPosition = inputStart;
+    m_bufferStart = start;
+    m_bufferCount = 0;
+    m_ringHead = 0;
+    return true;
+}
+
+bool AudioStreamReader::fill(qint64 end)
+{
+    const int size = m_ring.size();
+    while (m_bufferStart + m_bufferCount < end) {
+        // Entrada exata para as saídas que faltam: o decimador nunca
+        // produz mais do que cabe no buffer
+        qint64 needed = end - (m_bufferStart + m_bufferCount);
+        int frames = static_cast<int>(std::min<qint64>(kBlockFrames, needed * m_factor + m_warmup));
+        if (readInput(frames) < 0) {
+            return false;
+        }
+        m_warmup = std::max(0, m_warmup - frames);
+
+        const float *values = m_input.constData();
+        int produced = frames;
+        if (m_decimator) {
+            m_output.resize(frames / m_factor + 1);
+            produced = m_decimator->process(m_input.constData(), frames, m_output.data());
+            values = m_output.constData();
+        }
+
+        for (int i = 0; i < produced; ++i) {
+            m_ring[(m_ringHead + m_bufferCount) % size] = values[i];
+            ++m_bufferCount;
+        }
+    }
+    return true;
+}
+
+int AudioStreamReader::readInput(int frames)
+{
+    m_input.resize(frames);
+
+    // Após o fim do arquivo a entrada é zero (esvazia o filtro)
+    qint64 available = std::max<qint64>(0, m_inputFrames - m_inputPosition);
+    int toRead = static_cast<int>(std::min<qint64>(frames, available));
+    int got = 0;
+    if (toRead > 0) {
+        m_interleaved.resize(toRead * m_numChannels);
+        got = static_cast<int>(sf_readf_float(m_file, m_interleaved.data(), toRead));
+        if (got < toRead && sf_error(m_file) != SF_ERR_NO_ERROR) {
+            m_lastError = QObject::tr("Erro ao ler arquivo: %1").arg(sf_strerror(m_file));
+            return -1;
+        }
+        for (int i = 0; i < got; ++i) {
+            m_input[i] = m_interleaved[i * m_numChannels + m_channel];
+        }
+    }
+    std::fill(m_input.begin() + got, m_input.end(), 0.0f);
+
+    m_inputPosition += frames;
+    return frames;
+}
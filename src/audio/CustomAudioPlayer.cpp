@@ -1,14 +1,24 @@
 #include "audio/CustomAudioPlayer.h"
+#include "audio/PlaybackStream.h"
 #include "models/AudioFile.h"
 #include "utils/Logger.h"
 #include <QTimer>
 #include <cstring>
 #include <algorithm>
 
+namespace {
+    // Reprodução em fluxo: segundos lidos à frente da posição
+    const int kStreamBufferSeconds = 2;
+
+    // Máximo de frames lidos do stream por vez no callback
+    const int kStreamBlockFrames = 4096;
+}
+
 CustomAudioPlayer::CustomAudioPlayer(QObject *parent)
     : QObject(parent)
     , m_stream(nullptr)
     , m_portAudioInitialized(false)
+    , m_numSamples(0)
     , m_sampleRate(44100)
     , m_channels(1)
     , m_playPosition(0)
@@ -105,6 +115,8 @@ void CustomAudioPlayer::setAudioFile(std::shared_ptr<AudioFile> audioFile)
     emit positionChanged(0);
     
     m_audioFile = audioFile;
+    m_playbackStream.reset();
+    m_numSamples = 0;
     
     if (!audioFile) {
         m_samples.clear();
@@ -112,14 +124,30 @@ void CustomAudioPlayer::setAudioFile(std::shared_ptr<AudioFile> audioFile)
         return;
     }
     
-    // Copiar samples do AudioFile
+    // Copiar samples do AudioFile; sem amostras na memória, ler do arquivo
     const QVector<float> &qsamples = audioFile->getSamples();
     m_samples.assign(qsamples.begin(), qsamples.end());
     m_sampleRate = audioFile->getSampleRate();
     m_channels = audioFile->getNumChannels();
+    m_numSamples = m_samples.size();
+    
+    if (m_samples.empty() && audioFile->getNumSamples() > 0) {
+        m_playbackStream = std::make_unique<PlaybackStream>(
+            audioFile->getFilePath(), 0, m_sampleRate * kStreamBufferSeconds);
+        if (!m_playbackStream->isOpen()) {
+            LOG_PLAYER(QString("ERRO ao abrir arquivo em fluxo: %1").arg(m_playbackStream->getLastError()));
+            emit errorOccurred(QString("Erro ao abrir arquivo para reprodução: %1")
+                .arg(m_playbackStream->getLastError()));
+            m_playbackStream.reset();
+            return;
+        }
+        m_streamBlock.assign(kStreamBlockFrames, 0.0f);
+        m_numSamples = static_cast<size_t>(m_playbackStream->numSamples());
+    }
     
-    LOG_PLAYER(QString("Arquivo carregado: %1 samples, %2 Hz, %3 canais")
-        .arg(m_samples.size()).arg(m_sampleRate).arg(m_channels));
+    LOG_PLAYER(QString("Arquivo carregado: %1 samples%2, %3 Hz, %4 canais")
+        .arg(m_numSamples).arg(m_playbackStream ? " (em fluxo)" : "")
+        .arg(m_sampleRate).arg(m_channels));
     
     // Criar novo stream
     PaStreamParameters outputParameters;
@@ -160,7 +188,7 @@ void CustomAudioPlayer::setAudioFile(std::shared_ptr<AudioFile> audioFile)
 
 void CustomAudioPlayer::play()
 {
-    if (!m_audioFile || m_samples.empty()) {
+    if (!m_audioFile || m_numSamples == 0) {
         LOG_PLAYER("ERRO: play() chamado sem arquivo");
         return;
     }
@@ -188,6 +216,9 @@ void CustomAudioPlayer::play()
             
             if (pos < start || pos >= end) {
                 m_playPosition = start;
+                if (m_playbackStream) {
+                    m_playbackStream->seek(start);
+                }
                 LOG_PLAYER(QString("Posicionado no início da região: %1").arg(start));
             }
         }
@@ -239,6 +270,9 @@ void CustomAudioPlayer::stop()
     }
     
     m_playPosition = 0;
+    if (m_playbackStream) {
+        m_playbackStream->seek(0);
+    }
     
     emit playbackStateChanged(0); // Stopped
     emit positionChanged(0);
@@ -256,9 +290,12 @@ void CustomAudioPlayer::setPosition(qint64 positionMs)
     if (!m_audioFile) return;
     
     size_t sample = (positionMs * m_sampleRate) / 1000;
-    sample = std::min(sample, m_samples.size());
+    sample = std::min(sample, m_numSamples);
     
     m_playPosition = sample;
+    if (m_playbackStream) {
+        m_playbackStream->seek(static_cast<qint64>(sample));
+    }
     
     LOG_PLAYER(QString("Posição definida: %1ms (%2 samples)").arg(positionMs).arg(sample));
     emit positionChanged(positionMs);
@@ -274,9 +311,9 @@ qint64 CustomAudioPlayer::position() const
 
 qint64 CustomAudioPlayer::duration() const
 {
-    if (!m_audioFile || m_samples.empty()) return 0;
+    if (!m_audioFile || m_numSamples == 0) return 0;
     
-    return (m_samples.size() * 1000) / m_sampleRate;
+    return (m_numSamples * 1000) / m_sampleRate;
 }
 
 void CustomAudioPlayer::setVolume(float volume)
@@ -349,6 +386,13 @@ int CustomAudioPlayer::audioCallback(const void *inputBuffer, void *outputBuffer
     
     size_t pos = player->m_playPosition.load();
     const std::vector<float> &samples = player->m_samples;
+    const size_t numSamples = player->m_numSamples;
+    
+    // Em fluxo: amostras lidas em blocos [blockStart, blockEnd) do stream
+    PlaybackStream *stream = player->m_playbackStream.get();
+    float *block = player->m_streamBlock.data();
+    size_t blockStart = 0;
+    size_t blockEnd = 0;
     float volume = player->m_volume.load();
     bool hasRegion = player->m_hasPlaybackRegion.load();
     size_t regionEnd = player->m_regionEndSample.load();
@@ -372,7 +416,7 @@ int CustomAudioPlayer::audioCallback(const void *inputBuffer, void *outputBuffer
         }
         
         // Verificar fim do arquivo
-        if (pos >= samples.size()) {
+        if (pos >= numSamples) {
             if (loop && !hasRegion) {
                 pos = 0; // Loop do arquivo completo
             } else {
@@ -386,9 +430,23 @@ int CustomAudioPlayer::audioCallback(const void *inputBuffer, void *outputBuffer
             }
         }
         
+        float value;
+        if (stream) {
+            if (pos < blockStart || pos >= blockEnd) {
+                size_t count = std::min({static_cast<size_t>(framesPerBuffer - i), numSamples - pos,
+                                         player->m_streamBlock.size()});
+                stream->read(static_cast<qint64>(pos), static_cast<int>(count), block);
+                blockStart = pos;
+                blockEnd = pos + count;
+            }
+            value = block[pos - blockStart];
+        } else {
+            value = samples[pos];
+        }
+        
         // Copiar sample com volume
         for (int ch = 0; ch < player->m_channels; ch++) {
-            *out++ = samples[pos] * volume;
+            *out++ = value * volume;
         }
         pos++;
     }
@@ -0,0 +1,123 @@
+#include "audio/Decimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Tamanho dos blocos em decimate()
+    const int kBlockSize = 65536;
+
+    // Produto escalar com quatro acumuladores independentes: sem dependência
+    // entre iterações, o compilador vetoriza o laço (SSE/AVX/NEON)
+    inline float dotProduct(const float *a, const float *b, int n)
+    {
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            s0 += a[i] * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+        for (; i < n; ++i) {
+            s0 += a[i] * b[i];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+}
+
+Decimator::Decimator(int factor, int tapsPerPhase)
+    : m_factor(std::max(1, factor))
+    , m_nextOutput(0)
+{
+    int numTaps = m_factor > 1 ? m_factor * std::max(2, tapsPerPhase) + 1 : 1;
+    m_kernel.resize(numTaps);
+
+    if (m_factor == 1) {
+        m_kernel[0] = 1.0f;
+    } else {
+        // Corte em 0.8 * nova Nyquist (ciclos por amostra de entrada)
+        double cutoff = 0.4 / m_factor;
+        double center = (numTaps - 1) / 2.0;
+        double sum = 0.0;
+        for (int k = 0; k < numTaps; ++k) {
+            double t = k - center;
+            double sinc = (t == 0.0) ? 2.0 * cutoff
+                                     : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+            double phase = 2.0 * M_PI * k / (numTaps - 1);
+            double window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+            m_kernel[k] = static_cast<float>(sinc * window);
+            sum += m_kernel[k];
+        }
+
+        // Ganho unitário em DC
+        for (float &h : m_kernel) {
+            h = static_cast<float>(h / sum);
+        }
+    }
+
+    reset();
+}
+
+void Decimator::reset(int firstOutput)
+{
+    // Histórico inicial em zero
+    m_buffer.fill(0.0f, numTaps() - 1);
+    m_nextOutput = std::max(0, firstOutput);
+}
+
+int Decimator::process(const float *input, int count, float *output)
+{
+    if (count <= 0) {
+        return 0;
+    }
+
+    const int history = numTaps() - 1;
+    m_buffer.resize(history + count);
+    std::copy(input, input + count, m_buffer.data() + history);
+
+    // A saída na posição pos do bloco usa as entradas [pos - history, pos];
+    // o filtro é simétrico, dispensando a inversão do kernel
+    const float *buffer = m_buffer.constData();
+    const float *kernel = m_kernel.constData();
+    const int taps = numTaps();
+    int produced = 0;
+    int pos = m_nextOutput;
+    for (; pos < count; pos += m_factor) {
+        output[produced++] = dotProduct(buffer + pos, kernel, taps);
+    }
+    m_nextOutput = pos - count;
+
+    // Manter apenas o histórico para o próximo bloco
+    std::copy(m_buffer.constEnd() - history, m_buffer.constEnd(), m_buffer.begin());
+    m_buffer.resize(history);
+
+    return produced;
+}
+
+QVector<float> Decimator::decimate(const QVector<float> &input, int factor)
+{
+    if (factor <= 1) {
+        return input;
+    }
+
+    Decimator decimator(factor);
+    const qint64 inputSize = input.size();
+    const qint64 outputSize = (inputSize + factor - 1) / factor;
+
+    // Primeira saída quando a entrada 0 chega ao centro do filtro
+    decimator.reset(decimator.delay());
+
+    QVector<float> output(outputSize + 1);
+    qint64 written = 0;
+    for (qint64 start = 0; start < inputSize; start += kBlockSize) {
+        int count = static_cast<int>(std::min<qint64>(kBlockSize, inputSize - start));
+        written += decimator.process(input.constData() + start, count, output.data() + written);
+    }
+
+    // Completar com zeros até a última saída sair do filtro
+    QVector<float> tail(decimator.delay(), 0.0f);
+    written += decimator.process(tail.constData(), tail.size(), output.data() + written);
+
+    output.resize(std::min(written, outputSize));
+    return output;
+}
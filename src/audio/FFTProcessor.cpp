@@ -0,0 +1,112 @@
+#include "audio/FFTProcessor.h"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+    // O planejador do FFTW não é thread-safe: todo acesso passa por este mutex
+    QMutex s_plannerMutex;
+    QHash<int, fftwf_plan> s_planCache;
+    bool s_wisdomLoaded = false;
+
+    // Funções auxiliares: devem ser chamadas com s_plannerMutex travado
+    void importWisdomLocked()
+    {
+        if (s_wisdomLoaded) {
+            return;
+        }
+        s_wisdomLoaded = true;
+
+        QString path = FFTProcessor::wisdomFilePath();
+        if (QFile::exists(path) &&
+            !fftwf_import_wisdom_from_filename(QFile::encodeName(path).constData())) {
+            qWarning() << "FFTProcessor: wisdom inválida ignorada:" << path;
+        }
+    }
+
+    void exportWisdomLocked()
+    {
+        QString path = FFTProcessor::wisdomFilePath();
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        if (!fftwf_export_wisdom_to_filename(QFile::encodeName(path).constData())) {
+            qWarning() << "FFTProcessor: não foi possível salvar a wisdom:" << path;
+        }
+    }
+}
+
+FFTProcessor::FFTProcessor(int fftSize)
+    : m_size(std::max(1, fftSize))
+    , m_input(nullptr)
+    , m_output(nullptr)
+    , m_plan(nullptr)
+{
+    m_input = fftwf_alloc_real(m_size);
+    m_output = fftwf_alloc_complex(numBins());
+    std::fill(m_input, m_input + m_size, 0.0f);
+
+    m_plan = planForSize(m_size);
+}
+
+FFTProcessor::~FFTProcessor()
+{
+    // O plano pertence ao cache; apenas os buffers são desta instância
+    fftwf_free(m_input);
+    fftwf_free(m_output);
+}
+
+void FFTProcessor::execute()
+{
+    // Execução "new-array": seguro em paralelo com o mesmo plano, pois os
+    // buffers vêm de fftwf_malloc e têm o mesmo alinhamento do planejamento
+    fftwf_execute_dft_r2c(m_plan, m_input, m_output);
+}
+
+fftwf_plan FFTProcessor::planForSize(int fftSize)
+{
+    QMutexLocker locker(&s_plannerMutex);
+
+    auto it = s_planCache.constFind(fftSize);
+    if (it != s_planCache.constEnd()) {
+        return it.value();
+    }
+
+    importWisdomLocked();
+
+    // FFTW_MEASURE sobrescreve os buffers: planejar com buffers temporários
+    float *in = fftwf_alloc_real(fftSize);
+    fftwf_complex *out = fftwf_alloc_complex(fftSize / 2 + 1);
+    fftwf_plan plan = fftwf_plan_dft_r2c_1d(fftSize, in, out, FFTW_MEASURE);
+    fftwf_free(in);
+    fftwf_free(out);
+
+    s_planCache.insert(fftSize, plan);
+
+    // Persistir a wisdom sempre que um novo tamanho for planejado
+    exportWisdomLocked();
+
+    return plan;
+}
+
+void FFTProcessor::loadWisdom()
+{
+    QMutexLocker locker(&s_plannerMutex);
+    importWisdomLocked();
+}
+
+void FFTProcessor::saveWisdom()
+{
+    QMutexLocker locker(&s_plannerMutex);
+    exportWisdomLocked();
+}
+
+QString FFTProcessor::wisdomFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation)
+           + "/fftwf_wisdom";
+}
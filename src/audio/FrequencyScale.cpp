@@ -0,0 +1,120 @@
+#include "audio/FrequencyScale.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Piso da escala logarítmica (evita log(0) com minFrequency = 0)
+    const double kMinLogFrequency = 20.0;
+}
+
+FrequencyScale::FrequencyScale(Type type, double minFrequency, double maxFrequency)
+    : m_type(type)
+    , m_minFrequency(std::max(0.0, minFrequency))
+    , m_maxFrequency(std::max(minFrequency + 1.0, maxFrequency))
+{
+    m_scaleMin = toScale(m_type, m_minFrequency);
+    m_scaleMax = toScale(m_type, m_maxFrequency);
+    if (m_scaleMax <= m_scaleMin) {
+        m_scaleMax = m_scaleMin + 1e-6;
+    }
+}
+
+double FrequencyScale::toPosition(double frequency) const
+{
+    return (toScale(m_type, frequency) - m_scaleMin) / (m_scaleMax - m_scaleMin);
+}
+
+double FrequencyScale::toFrequency(double position) const
+{
+    return fromScale(m_type, m_scaleMin + position * (m_scaleMax - m_scaleMin));
+}
+
+double FrequencyScale::toScale(Type type, double frequency)
+{
+    frequency = std::max(0.0, frequency);
+    switch (type) {
+        case Logarithmic:
+            return std::log(std::max(kMinLogFrequency, frequency));
+        case Bark:
+            return 26.81 * frequency / (1960.0 + frequency) - 0.53;
+        case Erb:
+            return 21.4 * std::log10(1.0 + 0.00437 * frequency);
+        case Linear:
+        default:
+            return frequency;
+    }
+}
+
+double FrequencyScale::fromScale(Type type, double value)
+{
+    switch (type) {
+        case Logarithmic:
+            return std::exp(value);
+        case Bark:
+            return 1960.0 * (value + 0.53) / (26.28 - value);
+        case Erb:
+            return (std::pow(10.0, value / 21.4) - 1.0) / 0.00437;
+        case Linear:
+        default:
+            return value;
+    }
+}
+
+FrequencyScale::Type FrequencyScale::typeFromName(const QString &name)
+{
+    if (name == "Log") {
+        return Logarithmic;
+    } else if (name == "Bark") {
+        return Bark;
+    } else if (name == "ERB") {
+        return Erb;
+    }
+    return Linear;
+}
+
+QStringList FrequencyScale::names()
+{
+    return QStringList() << "Linear" << "Log" << "Bark" << "ERB";
+}
+
+FrequencyRemap FrequencyRemap::build(const FrequencyScale &scale, double binFrequency,
+                                     int minBin, int numBins, int numRows)
+{
+    FrequencyRemap remap;
+    if (numBins <= 0 || numRows <= 0 || binFrequency <= 0.0) {
+        return remap;
+    }
+
+    remap.numRows = numRows;
+    remap.numBins = numBins;
+    remap.firstBin.resize(numRows);
+    remap.lastBin.resize(numRows);
+    remap.fraction.resize(numRows);
+
+    // Posição (em bins, relativa a minBin) de uma frequência; o bin b está
+    // centrado em b * binFrequency
+    auto binPosition = [&](double frequency) {
+        double position = frequency / binFrequency - minBin;
+        return std::max(0.0, std::min(static_cast<double>(numBins - 1), position));
+    };
+
+    for (int row = 0; row < numRows; ++row) {
+        double low = binPosition(scale.toFrequency(static_cast<double>(row) / numRows));
+        double high = binPosition(scale.toFrequency(static_cast<double>(row + 1) / numRows));
+
+        if (high - low <= 1.0) {
+            // Menos de um bin por linha: interpolação linear no centro
+            double center = binPosition(scale.toFrequency((row + 0.5) / numRows));
+            int first = std::min(numBins - 1, static_cast<int>(std::floor(center)));
+            remap.firstBin[row] = first;
+            remap.lastBin[row] = std::min(numBins - 1, first + 1);
+            remap.fraction[row] = static_cast<float>(center - first);
+        } else {
+            // Vários bins por linha: máximo dos bins cobertos
+            remap.firstBin[row] = static_cast<int>(std::round(low));
+            remap.lastBin[row] = std::max(remap.firstBin[row], static_cast<int>(std::round(high)) - 1);
+            remap.fraction[row] = -1.0f;
+        }
+    }
+    return remap;
+}
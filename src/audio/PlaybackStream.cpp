@@ -0,0 +1,144 @@
+#include "audio/PlaybackStream.h"
+#include "audio/AudioStreamReader.h"
+#include "utils/Logger.h"
+#include <QThread>
+#include <algorithm>
+
+namespace {
+    // Amostras lidas do arquivo por vez
+    const int kChunkSamples = 8192;
+
+    // Intervalo (ms) entre verificações quando o buffer está cheio
+    const unsigned long kIdleWaitMs = 10;
+}
+
+PlaybackStream::PlaybackStream(const QString &filePath, int channel, int capacity)
+    : m_filePath(filePath)
+    , m_channel(channel)
+    , m_numSamples(0)
+    , m_windowStart(0)
+    , m_windowCount(0)
+    , m_readPosition(0)
+    , m_requestedPosition(-1)
+    , m_stop(false)
+    , m_thread(nullptr)
+{
+    // Abrir uma vez aqui para validar o arquivo e saber sua duração
+    AudioStreamReader probe(filePath, channel, 1, 1);
+    if (!probe.isOpen()) {
+        m_lastError = probe.getLastError();
+        return;
+    }
+    m_numSamples = probe.numSamples();
+    m_ring.resize(std::max(kChunkSamples, capacity));
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+PlaybackStream::~PlaybackStream()
+{
+    if (m_thread) {
+        m_stop = true;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_wakeUp.wakeAll();
+        }
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void PlaybackStream::seek(qint64 position)
+{
+    m_requestedPosition = std::max<qint64>(0, position);
+    QMutexLocker locker(&m_mutex);
+    m_wakeUp.wakeAll();
+}
+
+bool PlaybackStream::read(qint64 position, int count, float *dst)
+{
+    std::fill(dst, dst + count, 0.0f);
+    m_readPosition = position + count;
+
+    // Nunca esperar pela thread de leitura no callback de áudio
+    if (!m_mutex.tryLock()) {
+        return false;
+    }
+    const int size = m_ring.size();
+    const qint64 first = std::max(position, m_windowStart);
+    const qint64 last = std::min(position + count, m_windowStart + m_windowCount);
+    for (qint64 n = first; n < last; ++n) {
+        dst[n - position] = m_ring[static_cast<int>(n % size)];
+    }
+    bool complete = first == position && last == position + count;
+    bool inWindow = position >= m_windowStart && position <= m_windowStart + m_windowCount;
+    m_mutex.unlock();
+
+    // Posição fora do trecho lido: pedir a leitura a partir dela
+    if (!inWindow && position < m_numSamples) {
+        m_requestedPosition = position;
+    }
+    return complete || position + count > m_numSamples;
+}
+
+void PlaybackStream::run()
+{
+    AudioStreamReader reader(m_filePath, m_channel, 1, kChunkSamples);
+    if (!reader.isOpen()) {
+        LOG_PLAYER(QString("ERRO ao abrir arquivo para reprodução: %1").arg(reader.getLastError()));
+        return;
+    }
+
+    QVector<float> chunk(kChunkSamples);
+    const int size = m_ring.size();
+    while (!m_stop) {
+        qint64 writePosition = 0;
+        int space = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+
+            // Seek: recomeçar o buffer na posição pedida, se ela não estiver nele
+            qint64 requested = m_requestedPosition.exchange(-1);
+            if (requested >= 0) {
+                if (requested < m_windowStart || requested > m_windowStart + m_windowCount) {
+                    m_windowStart = requested;
+                    m_windowCount = 0;
+                }
+                m_readPosition = requested;
+            }
+
+            // Descartar o que a reprodução já consumiu
+            qint64 consumed = m_readPosition.load();
+            if (consumed > m_windowStart && consumed <= m_windowStart + m_windowCount) {
+                m_windowCount -= static_cast<int>(consumed - m_windowStart);
+                m_windowStart = consumed;
+            }
+
+            writePosition = m_windowStart + m_windowCount;
+            space = size - m_windowCount;
+            if (space < kChunkSamples || writePosition >= m_numSamples) {
+                if (m_requestedPosition.load() < 0 && !m_stop) {
+                    m_wakeUp.wait(&m_mutex, kIdleWaitMs);
+                }
+                continue;
+            }
+        }
+
+        // Ler fora do mutex: o callback só espera pela cópia abaixo
+        int count = static_cast<int>(std::min<qint64>(kChunkSamples, m_numSamples - writePosition));
+        if (!reader.read(writePosition, count, chunk.data())) {
+            LOG_PLAYER(QString("ERRO ao ler arquivo para reprodução: %1").arg(reader.getLastError()));
+            return;
+        }
+
+        QMutexLocker locker(&m_mutex);
+        if (m_windowStart + m_windowCount != writePosition) {
+            continue;       // Seek durante a leitura: bloco descartado
+        }
+        for (int i = 0; i < count; ++i) {
+            m_ring[static_cast<int>((writePosition + i) % size)] = chunk[i];
+        }
+        m_windowCount += count;
+    }
+}
@@ -0,0 +1,64 @@
+#include "audio/SincInterpolator.h"
+#include <algorithm>
+#include <cmath>
+
+SincInterpolator::SincInterpolator(int tapsPerSide, int numPhases)
+    : m_tapsPerSide(std::max(1, tapsPerSide))
+    , m_numPhases(std::max(1, numPhases))
+{
+    const int numTaps = 2 * m_tapsPerSide;
+    m_table.resize(m_numPhases * numTaps);
+
+    // Fase p: posição fracionária p / numPhases depois da amostra n; o
+    // coeficiente k multiplica a amostra n - tapsPerSide + 1 + k
+    for (int phase = 0; phase < m_numPhases; ++phase) {
+        double fraction = static_cast<double>(phase) / m_numPhases;
+        float *taps = m_table.data() + phase * numTaps;
+        double sum = 0.0;
+        for (int k = 0; k < numTaps; ++k) {
+            double x = fraction - (k - m_tapsPerSide + 1);
+            double sinc = std::abs(x) < 1e-9 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+            double u = x / m_tapsPerSide;
+            double window = std::abs(u) >= 1.0
+                ? 0.0
+                : 0.42 + 0.5 * std::cos(M_PI * u) + 0.08 * std::cos(2.0 * M_PI * u);
+            taps[k] = static_cast<float>(sinc * window);
+            sum += taps[k];
+        }
+        for (int k = 0; k < numTaps; ++k) {
+            taps[k] = static_cast<float>(taps[k] / sum);
+        }
+    }
+}
+
+float SincInterpolator::valueAt(const float *samples, int count, double position) const
+{
+    double base = std::floor(position);
+    int phase = static_cast<int>(std::lround((position - base) * m_numPhases));
+    qint64 n = static_cast<qint64>(base);
+    if (phase == m_numPhases) {
+        phase = 0;
+        ++n;
+    }
+
+    const int numTaps = 2 * m_tapsPerSide;
+    const float *taps = m_table.constData() + phase * numTaps;
+    const qint64 first = n - m_tapsPerSide + 1;
+
+    float result = 0.0f;
+    if (first >= 0 && first + numTaps <= count) {
+        // Caso comum: todas as amostras dentro do sinal
+        const float *s = samples + first;
+        for (int k = 0; k < numTaps; ++k) {
+            result += s[k] * taps[k];
+        }
+    } else {
+        for (int k = 0; k < numTaps; ++k) {
+            qint64 index = first + k;
+            if (index >= 0 && index < count) {
+                result += samples[index] * taps[k];
+            }
+        }
+    }
+    return result;
+}
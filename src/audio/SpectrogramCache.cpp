@@ -0,0 +1,245 @@
+#include "audio/SpectrogramCache.h"
+#include <QHashFunctions>
+#include <QMutexLocker>
+#include <QSettings>
+#include <algorithm>
+
+namespace {
+    // Orçamento padrão do cache em memória (MB)
+    const int kDefaultMaxSizeMB = 512;
+
+    const bool kDefaultQuantized = true;
+
+    int costKB(qint64 bytes)
+    {
+        return static_cast<int>(std::max<qint64>(1, bytes / 1024));
+    }
+
+    // Níveis de 8 bits -> tile.db (nada a fazer se o tile foi guardado em float)
+    void dequantize(const QByteArray &quantized, SpectrogramTile &tile)
+    {
+        if (quantized.isEmpty()) {
+            return;
+        }
+        const uchar *levels = reinterpret_cast<const uchar *>(quantized.constData());
+        tile.db.resize(quantized.size());
+        for (qsizetype i = 0; i < quantized.size(); ++i) {
+            tile.db[i] = SpectrogramCalculator::dequantizeDb(levels[i]);
+        }
+    }
+}
+
+size_t qHash(const SpectrogramCacheKey &key, size_t seed)
+{
+    const SpectrogramCalculator::Parameters &p = key.params;
+    return qHashMulti(seed, key.fileId, key.level, key.index,
+                      p.timeStep, p.timeWindow, p.fftSize, static_cast<int>(p.windowType),
+                      p.minFrequency, p.maxFrequency, p.preEmphasis, p.preEmphasisFactor,
+                      static_cast<int>(p.pooling));
+}
+
+SpectrogramCache& SpectrogramCache::instance()
+{
+    static SpectrogramCache instance;
+    return instance;
+}
+
+SpectrogramCache::SpectrogramCache()
+    : m_prefetchedBytes(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_insertions(0)
+{
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    int maxSizeMB = settings.value("spectrogram/memoryCacheMB", kDefaultMaxSizeMB).toInt();
+    m_tiles.setMaxCost(std::max(1, maxSizeMB) * 1024);
+    m_quantized = settings.value("spectrogram/quantizedCache", kDefaultQuantized).toBool();
+}
+
+bool SpectrogramCache::contains(const SpectrogramCacheKey &key) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tiles.contains(key);
+}
+
+bool SpectrogramCache::containsComplete(const SpectrogramCacheKey &key) const
+{
+    QMutexLocker locker(&m_mutex);
+    // object() também marca a entrada como usada recentemente
+    const Entry *entry = m_tiles.object(key);
+    return entry && !entry->tile.preview;
+}
+
+SpectrogramTile SpectrogramCache::tile(const SpectrogramCacheKey &key)
+{
+    QByteArray quantized;
+    SpectrogramTile tile = tileLevels(key, quantized);
+    
+    // Conversão dos níveis fora do mutex (cópias implicitamente compartilhadas)
+    dequantize(quantized, tile);
+    return tile;
+}
+
+SpectrogramTile SpectrogramCache::tileLevels(const SpectrogramCacheKey &key, QByteArray &levels)
+{
+    QMutexLocker locker(&m_mutex);
+    // object() também marca a entrada como usada recentemente
+    Entry *entry = m_tiles.object(key);
+    if (!entry) {
+        ++m_misses;
+        levels = QByteArray();
+        return SpectrogramTile();
+    }
+    ++m_hits;
+    // Lido pela visualização: deixa de contar como pré-cálculo
+    if (entry->prefetchedBytes) {
+        m_prefetchedBytes -= entry->bytes;
+        entry->prefetchedBytes = nullptr;
+    }
+    levels = entry->levels;
+    return entry->tile;
+}
+
+SpectrogramTile SpectrogramCache::peek(const SpectrogramCacheKey &key) const
+{
+    SpectrogramTile tile;
+    QByteArray quantized;
+    {
+        QMutexLocker locker(&m_mutex);
+        const Entry *entry = m_tiles.object(key);
+        if (!entry) {
+            return SpectrogramTile();
+        }
+        tile = entry->tile;
+        quantized = entry->levels;
+    }
+    
+    dequantize(quantized, tile);
+    return tile;
+}
+
+bool SpectrogramCache::levelAt(const SpectrogramCacheKey &key, int column, int bin, float &db) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Entry *entry = m_tiles.object(key);
+    if (!entry || column < 0 || column >= entry->tile.numColumns ||
+        bin < 0 || bin >= entry->tile.numBins) {
+        return false;
+    }
+    
+    // Só a célula pedida é convertida
+    const qsizetype offset = static_cast<qsizetype>(column) * entry->tile.numBins + bin;
+    if (!entry->levels.isEmpty()) {
+        db = SpectrogramCalculator::dequantizeDb(static_cast<quint8>(entry->levels[offset]));
+    } else {
+        db = entry->tile.db[offset];
+    }
+    return true;
+}
+
+void SpectrogramCache::insert(const SpectrogramCacheKey &key, const SpectrogramTile &tile, bool prefetched)
+{
+    if (tile.isNull()) {
+        return;
+    }
+
+    Entry *entry = new Entry;
+    entry->tile = tile;
+    qint64 bytes = static_cast<qint64>(tile.db.size()) * sizeof(float);
+    if (isQuantized()) {
+        // Mesma ordem de tile.db (coluna a coluna)
+        entry->levels.resize(tile.db.size());
+        uchar *levels = reinterpret_cast<uchar *>(entry->levels.data());
+        for (qsizetype i = 0; i < tile.db.size(); ++i) {
+            levels[i] = SpectrogramCalculator::quantizeDb(tile.db[i]);
+        }
+        entry->tile.db = QVector<float>();
+        bytes = entry->levels.size();
+    }
+    
+    entry->bytes = bytes;
+    
+    QMutexLocker locker(&m_mutex);
+    const Entry *existing = m_tiles.object(key);
+    if (tile.preview && existing && !existing->tile.preview) {
+        delete entry;
+        return;
+    }
+    if (prefetched) {
+        entry->prefetchedBytes = &m_prefetchedBytes;
+        m_prefetchedBytes += bytes;
+    }
+    // Entradas substituídas ou descartadas (inclusive esta, se não couber)
+    // se descontam de m_prefetchedBytes no destrutor
+    m_tiles.insert(key, entry, costKB(bytes));
+    ++m_insertions;
+}
+
+qint64 SpectrogramCache::prefetchedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_prefetchedBytes;
+}
+
+void SpectrogramCache::removeFile(quint64 fileId)
+{
+    QMutexLocker locker(&m_mutex);
+    const QList<SpectrogramCacheKey> keys = m_tiles.keys();
+    for (const SpectrogramCacheKey &key : keys) {
+        if (key.fileId == fileId) {
+            m_tiles.remove(key);
+        }
+    }
+}
+
+void SpectrogramCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_tiles.clear();
+}
+
+int SpectrogramCache::maxSizeMB() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_tiles.maxCost() / 1024);
+}
+
+void SpectrogramCache::setMaxSizeMB(int megabytes)
+{
+    QMutexLocker locker(&m_mutex);
+    // Reduzir o limite descarta imediatamente os tiles menos usados
+    m_tiles.setMaxCost(std::max(1, megabytes) * 1024);
+}
+
+bool SpectrogramCache::isQuantized() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_quantized;
+}
+
+void SpectrogramCache::setQuantized(bool quantized)
+{
+    QMutexLocker locker(&m_mutex);
+    m_quantized = quantized;
+}
+
+SpectrogramCache::Statistics SpectrogramCache::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    Statistics stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.insertions = m_insertions;
+    stats.entries = static_cast<int>(m_tiles.count());
+    stats.sizeBytes = static_cast<qint64>(m_tiles.totalCost()) * 1024;
+    stats.maxSizeBytes = static_cast<qint64>(m_tiles.maxCost()) * 1024;
+    return stats;
+}
+
+void SpectrogramCache::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+    m_insertions = 0;
+}
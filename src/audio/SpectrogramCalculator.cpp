@@ -1,16 +1,220 @@
 #include "audio/SpectrogramCalculator.h"
+#include "audio/AudioStreamReader.h"
+#include "audio/Decimator.h"
+#include "audio/FFTProcessor.h"
+#include "audio/SpectrogramDiskCache.h"
+#include "audio/SpectrumKernels.h"
 #include "models/AudioFile.h"
 #include <QtConcurrent>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QThreadPool>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <complex>
+#include <limits>
+#include <memory>
+
+namespace {
+    const int MaxAnalyses = SpectrogramCalculator::MaxAnalyses;
+    
+    // Tile em cálculo (de uma das análises)
+    struct TileJob {
+        SpectrogramTile tile;
+        bool pooled = false;        // Obtido dos tiles do nível anterior
+        bool fromDisk = false;      // Lido do cache em disco
+        bool complete = false;      // Já entregue (tileReady)
+        int firstChunk = 0;         // Blocos de colunas do tile
+        int numChunks = 0;
+    };
+    
+    // Faixa de colunas de um índice de tile processada por uma tarefa do
+    // pool, para todas as análises que precisam de FFT nesse tile
+    struct ColumnChunk {
+        int job[MaxAnalyses] = {-1, -1};   // Tile de cada análise (-1: nenhum)
+        int begin = 0;
+        int end = 0;
+        float minDb[MaxAnalyses];
+        float maxDb[MaxAnalyses];
+        
+        ColumnChunk() {
+            std::fill(minDb, minDb + MaxAnalyses, std::numeric_limits<float>::max());
+            std::fill(maxDb, maxDb + MaxAnalyses, std::numeric_limits<float>::lowest());
+        }
+    };
+    
+    // Análise de um pedido: geometria, janela e tiles do nível anterior
+    struct AnalysisSetup {
+        SpectrogramCalculator::Parameters params;   // Análise simples equivalente
+        SpectrogramCalculator::Geometry geometry;
+        QVector<float> window;
+        float referenceDb = 0.0f;
+        QString paramsKey;
+        QHash<int, SpectrogramTile> sources;
+    };
+    
+    // Tabelas de janela por (tipo, tamanho)
+    QMutex s_windowMutex;
+    QHash<quint64, QVector<float>> s_windowCache;
+    
+    // Buffers de trabalho de uma thread: amostras do frame (com uma amostra
+    // anterior para a pré-ênfase), lidas uma vez para todas as análises, e
+    // FFT (buffers alinhados) e dB da coluna de cada análise. Em fluxo,
+    // também o leitor do arquivo, mantido entre blocos de colunas
+    struct FrameWorkspace {
+        QVector<float> frame;
+        QVector<float> spectrumDb[MaxAnalyses];
+        std::unique_ptr<FFTProcessor> fft[MaxAnalyses];
+        
+        std::unique_ptr<AudioStreamReader> reader;
+        QString readerPath;
+        int readerFactor = 0;
+        int readerCapacity = 0;
+    };
+    
+    // Cada thread do pool mantém seu workspace entre blocos e cálculos,
+    // recriando-o apenas quando o tamanho da janela ou da FFT muda
+    FrameWorkspace &localWorkspace(int frameSize, const AnalysisSetup *analyses, int numAnalyses)
+    {
+        thread_local FrameWorkspace ws;
+        if (ws.frame.size() != frameSize + 1) {
+            ws.frame.resize(frameSize + 1);
+        }
+        for (int a = 0; a < numAnalyses; ++a) {
+            const SpectrogramCalculator::Geometry &geometry = analyses[a].geometry;
+            if (ws.spectrumDb[a].size() != geometry.numBins()) {
+                ws.spectrumDb[a].resize(geometry.numBins());
+            }
+            if (!ws.fft[a] || ws.fft[a]->size() != geometry.fftSize) {
+                ws.fft[a] = std::make_unique<FFTProcessor>(geometry.fftSize);
+            }
+        }
+        return ws;
+    }
+    
+    // Leitor em fluxo do workspace, reaberto apenas quando o arquivo, o
+    // fator de decimação ou o tamanho do buffer mudam (ou após falha ao
+    // abrir): blocos seguidos da mesma thread continuam a leitura sem
+    // reabrir o arquivo nem reaquecer o decimador
+    AudioStreamReader &localReader(FrameWorkspace &ws, const QString &filePath, int factor, int capacity)
+    {
+        if (!ws.reader || !ws.reader->isOpen() || ws.readerPath != filePath || ws.readerFactor != factor
+            || ws.readerCapacity < capacity) {
+            ws.reader = std::make_unique<AudioStreamReader>(filePath, 0, factor, capacity);
+            ws.readerPath = filePath;
+            ws.readerFactor = factor;
+            ws.readerCapacity = capacity;
+        }
+        return *ws.reader;
+    }
+    
+    // Lê amostras [start, start + count) do sinal (já decimado).
+    // Posições fora do sinal viram zero.
+    void readSamples(const QVector<float> &source, qint64 start, int count, float *dst)
+    {
+        const qint64 sourceSize = source.size();
+        qint64 first = std::max<qint64>(0, start);
+        qint64 last = std::min<qint64>(sourceSize, start + count);
+        
+        if (first >= last) {
+            std::fill(dst, dst + count, 0.0f);
+            return;
+        }
+        std::fill(dst, dst + (first - start), 0.0f);
+        std::copy(source.constData() + first, source.constData() + last, dst + (first - start));
+        std::fill(dst + (last - start), dst + count, 0.0f);
+    }
+    
+    // Lê amostras decimadas [start, start + count) de um sinal original em
+    // memória, decimando apenas o trecho necessário (com margem para o
+    // filtro). Usado pela prévia, que não deve decimar o arquivo inteiro.
+    void readDecimatedSamples(const QVector<float> &source, int factor, qint64 start, int count,
+                              float *dst, QVector<float> &scratch)
+    {
+        if (factor <= 1) {
+            readSamples(source, start, count, dst);
+            return;
+        }
+        const int margin = 16;      // Saídas; cobre o meio filtro do Decimator
+        scratch.resize((count + 2 * margin) * factor);
+        readSamples(source, (start - margin) * factor, scratch.size(), scratch.data());
+        QVector<float> decimated = Decimator::decimate(scratch, factor);
+        std::copy(decimated.constData() + margin, decimated.constData() + margin + count, dst);
+    }
+    
+    // Referência de 0 dB: senoide de fundo de escala (ganho da janela / 2).
+    // Uma referência absoluta mantém a mesma escala em todos os tiles.
+    float referenceLevelDb(const QVector<float> &window)
+    {
+        double windowGain = 0.0;
+        for (float w : window) {
+            windowGain += w;
+        }
+        return 20.0f * std::log10(static_cast<float>(windowGain / 2.0) + 1e-10f);
+    }
+    
+    // Kernel único de preparação do frame: pré-ênfase, janela e
+    // zero-padding até fftSize, direto no buffer da FFT.
+    // `samples` tem windowSize + 1 valores: samples[0] é a amostra anterior.
+    inline void prepareFrame(const float *samples, const float *window, int windowSize,
+                             float preEmphasis, float *dst, int fftSize)
+    {
+        if (preEmphasis != 0.0f) {
+            for (int i = 0; i < windowSize; ++i) {
+                dst[i] = (samples[i + 1] - preEmphasis * samples[i]) * window[i];
+            }
+        } else {
+            for (int i = 0; i < windowSize; ++i) {
+                dst[i] = samples[i + 1] * window[i];
+            }
+        }
+        std::fill(dst + windowSize, dst + fftSize, 0.0f);
+    }
+    
+    // Acumula uma coluna em dst (máximo ou soma, normalizada depois)
+    inline void poolColumn(float *dst, const float *src, int numBins, bool first,
+                           SpectrogramCalculator::PoolingMode mode)
+    {
+        if (first) {
+            std::copy(src, src + numBins, dst);
+        } else if (mode == SpectrogramCalculator::MaxPooling) {
+            for (int bin = 0; bin < numBins; ++bin) {
+                dst[bin] = std::max(dst[bin], src[bin]);
+            }
+        } else {
+            for (int bin = 0; bin < numBins; ++bin) {
+                dst[bin] += src[bin];
+            }
+        }
+    }
+    
+    inline void finishPool(float *dst, int numBins, int count,
+                           SpectrogramCalculator::PoolingMode mode)
+    {
+        if (mode == SpectrogramCalculator::MeanPooling && count > 1) {
+            float scale = 1.0f / count;
+            for (int bin = 0; bin < numBins; ++bin) {
+                dst[bin] *= scale;
+            }
+        }
+    }
+}
 
 SpectrogramCalculator::SpectrogramCalculator(QObject *parent) 
     : QObject(parent)
+    , m_threadPool(QThreadPool::globalInstance())
+    , m_level(0)
+    , m_generation(0)
+    , m_cancelledGeneration(0)
     , m_isCalculating(false)
-    , m_cancelRequested(false)
+    , m_hasPendingRequest(false)
 {
+    qRegisterMetaType<SpectrogramTile>("SpectrogramTile");
 }
 
 SpectrogramCalculator::~SpectrogramCalculator()
@@ -18,301 +222,830 @@ SpectrogramCalculator::~SpectrogramCalculator()
     cancel();
 }
 
-void SpectrogramCalculator::calculate(std::shared_ptr<AudioFile> audioFile, const Parameters &params)
+SpectrogramCalculator::Geometry SpectrogramCalculator::computeGeometry(const Parameters &params,
+                                                                       int sampleRate,
+                                                                       qint64 numSamples)
 {
-    if (m_isCalculating) {
-        emit calculationError("Cálculo já em andamento");
-        return;
+    Geometry geometry;
+    if (sampleRate <= 0 || numSamples <= 0) {
+        return geometry;
+    }
+    
+    // Otimização: Downsampling se maxFrequency < Nyquist/2
+    // Inspirado no Praat - reduz drasticamente o número de amostras
+    double nyquist = sampleRate / 2.0;
+    int downsampleFactor = 1;
+    if (params.maxFrequency > 0.0 && params.maxFrequency < nyquist / 2.0) {
+        downsampleFactor = static_cast<int>(nyquist / (params.maxFrequency * 2.0));
+        downsampleFactor = std::max(1, std::min(downsampleFactor, 8)); // Limitar a 8x
+    }
+    
+    geometry.downsampleFactor = downsampleFactor;
+    geometry.sampleRate = sampleRate / downsampleFactor;
+    qint64 decimatedSamples = (numSamples + downsampleFactor - 1) / downsampleFactor;
+    
+    geometry.windowSize = static_cast<int>(params.timeWindow * geometry.sampleRate);
+    geometry.hopSize = static_cast<int>(params.timeStep * geometry.sampleRate);
+    if (geometry.windowSize <= 0 || geometry.hopSize <= 0) {
+        return geometry;
     }
     
+    // Ajustar FFT size para próxima potência de 2 acima do windowSize
+    geometry.fftSize = nextPowerOfTwo(geometry.windowSize);
+    geometry.frameDuration = static_cast<double>(geometry.hopSize) / geometry.sampleRate;
+    geometry.numFrames = static_cast<int>((decimatedSamples + geometry.hopSize - 1) / geometry.hopSize);
+    
+    // Calcular limites de frequência em bins
+    int numFreqBins = geometry.fftSize / 2 + 1;
+    int minBin = static_cast<int>(params.minFrequency * geometry.fftSize / geometry.sampleRate);
+    int maxBin = static_cast<int>(params.maxFrequency * geometry.fftSize / geometry.sampleRate);
+    geometry.minBin = std::max(0, std::min(minBin, numFreqBins - 1));
+    geometry.maxBin = std::max(geometry.minBin + 1, std::min(maxBin, numFreqBins));
+    
+    return geometry;
+}
+
+quint64 SpectrogramCalculator::calculate(std::shared_ptr<AudioFile> audioFile, const Parameters &params,
+                                         int level, const QVector<int> &tiles,
+                                         const QVector<SpectrogramTile> &sources)
+{
     if (!audioFile) {
-        emit calculationError("Arquivo de áudio inválido");
-        return;
+        emit calculationError(0, "Arquivo de áudio inválido");
+        return 0;
     }
     
-    m_audioFile = audioFile;
-    m_params = params;
-    m_isCalculating = true;
-    m_cancelRequested = false;
+    quint64 generation = 0;
+    quint64 replaced = 0;
+    {
+        QMutexLocker locker(&m_requestMutex);
+        
+        // Um pedido ainda não iniciado é substituído pelo novo
+        if (m_hasPendingRequest) {
+            replaced = m_pendingRequest.generation;
+        }
+        
+        // Nova geração: o cálculo em andamento (se houver) fica obsoleto e
+        // para no próximo ponto de verificação
+        generation = ++m_generation;
+        m_pendingRequest.generation = generation;
+        m_pendingRequest.audioFile = audioFile;
+        m_pendingRequest.params = params;
+        m_pendingRequest.level = level;
+        m_pendingRequest.tiles = tiles;
+        m_pendingRequest.sources = sources;
+        m_hasPendingRequest = true;
+        m_isCalculating = true;
+    }
     
-    emit calculationStarted();
+    if (replaced != 0) {
+        emit calculationCancelled(replaced);
+    }
+    emit calculationStarted(generation);
     
     // Emitir sinal para executar na thread do objeto
     emit startCalculationInThread();
+    return generation;
+}
+
+void SpectrogramCalculator::setThreadPool(QThreadPool *pool)
+{
+    m_threadPool = pool ? pool : QThreadPool::globalInstance();
 }
 
 void SpectrogramCalculator::cancel()
 {
-    m_cancelRequested = true;
+    // Todas as gerações emitidas até agora ficam obsoletas
+    m_cancelledGeneration = m_generation.load();
+}
+
+bool SpectrogramCalculator::isObsolete(quint64 generation) const
+{
+    return generation != m_generation.load() || generation <= m_cancelledGeneration.load();
+}
+
+void SpectrogramCalculator::finishRequest()
+{
+    QMutexLocker locker(&m_requestMutex);
+    m_isCalculating = m_hasPendingRequest;
 }
 
 void SpectrogramCalculator::performCalculation()
 {
+    // Assumir o pedido mais recente; sinais enfileirados de pedidos já
+    // substituídos não encontram nada a fazer
+    quint64 generation = 0;
+    {
+        QMutexLocker locker(&m_requestMutex);
+        if (!m_hasPendingRequest) {
+            return;
+        }
+        generation = m_pendingRequest.generation;
+        m_audioFile = m_pendingRequest.audioFile;
+        m_params = m_pendingRequest.params;
+        m_level = m_pendingRequest.level;
+        m_tiles = m_pendingRequest.tiles;
+        m_sources = m_pendingRequest.sources;
+        m_pendingRequest = Request();
+        m_hasPendingRequest = false;
+    }
+    
+    if (isObsolete(generation)) {
+        finishRequest();
+        emit calculationCancelled(generation);
+        return;
+    }
+    
     try {
-        QVector<float> samples = m_audioFile->getSamples();
-        int sampleRate = m_audioFile->getSampleRate();
-        double duration = m_audioFile->getDuration();
+        // Sem amostras em memória (arquivo não decodificado): STFT em fluxo,
+        // lendo do arquivo apenas a janela de cada frame
+        const bool streaming = m_audioFile->getSamples().isEmpty();
         
-        // Otimização: Downsampling se maxFrequency < Nyquist/2
-        // Inspirado no Praat - reduz drasticamente o número de amostras
-        double nyquist = sampleRate / 2.0;
-        int downsampleFactor = 1;
-        if (m_params.maxFrequency < nyquist / 2.0) {
-            downsampleFactor = static_cast<int>(nyquist / (m_params.maxFrequency * 2.0));
-            downsampleFactor = std::max(1, std::min(downsampleFactor, 8)); // Limitar a 8x
-            
-            if (downsampleFactor > 1) {
-                // Fazer downsampling simples (média)
-                QVector<float> downsampledSamples;
-                downsampledSamples.reserve(samples.size() / downsampleFactor);
-                
-                for (int i = 0; i < samples.size(); i += downsampleFactor) {
-                    float sum = 0.0f;
-                    int count = 0;
-                    for (int j = 0; j < downsampleFactor && (i + j) < samples.size(); ++j) {
-                        sum += samples[i + j];
-                        count++;
-                    }
-                    downsampledSamples.append(sum / count);
-                }
-                
-                samples = downsampledSamples;
-                sampleRate = sampleRate / downsampleFactor;
+        // Análises do pedido (duas na análise dupla). Todas têm a mesma
+        // decimação, o mesmo passo e portanto os mesmos frames e tiles.
+        const int numAnalyses = m_params.numAnalyses();
+        AnalysisSetup analyses[MaxAnalyses];
+        for (int a = 0; a < numAnalyses; ++a) {
+            AnalysisSetup &analysis = analyses[a];
+            analysis.params = m_params.analysis(a);
+            analysis.geometry = computeGeometry(analysis.params, m_audioFile->getSampleRate(),
+                                                m_audioFile->getNumSamples());
+            if (!analysis.geometry.isValid()) {
+                finishRequest();
+                emit calculationError(generation, "Parâmetros inválidos");
+                return;
             }
+            analysis.window = windowTable(analysis.params.windowType, analysis.geometry.windowSize);
+            analysis.referenceDb = referenceLevelDb(analysis.window);
+            analysis.paramsKey = parametersKey(analysis.params);
         }
         
-        // Calcular região de tempo
-        double startTime = m_params.startTime;
-        double calcDuration = m_params.windowDuration > 0 ? m_params.windowDuration : m_params.maxDuration;
-        calcDuration = std::min(calcDuration, duration - startTime);
-        
-        // Converter para índices de amostra
-        int startSample = static_cast<int>(startTime * sampleRate);
-        int endSample = static_cast<int>((startTime + calcDuration) * sampleRate);
+        const Geometry &geometry = analyses[0].geometry;
+        const int level = std::max(0, std::min(m_level, geometry.maxLevel()));
+        const int hopSize = geometry.hopSize;
+        const int framesPerColumn = geometry.framesPerColumn(level);
+        const PoolingMode pooling = m_params.pooling;
+        const float preEmphasis = m_params.preEmphasis ? static_cast<float>(m_params.preEmphasisFactor) : 0.0f;
         
-        startSample = std::max(0, std::min(startSample, static_cast<int>(samples.size()) - 1));
-        endSample = std::max(startSample + 1, std::min(endSample, static_cast<int>(samples.size())));
-        
-        int numSamples = endSample - startSample;
-        
-        // Parâmetros do espectrograma
-        int windowSize = static_cast<int>(m_params.timeWindow * sampleRate);
-        int hopSize = static_cast<int>(m_params.timeStep * sampleRate);
+        // Cada frame é lido com a maior janela; a análise a usa a parte
+        // centrada a partir de frameOffset[a]
+        int frameSize = 0;
+        for (int a = 0; a < numAnalyses; ++a) {
+            frameSize = std::max(frameSize, analyses[a].geometry.windowSize);
+        }
+        int frameOffset[MaxAnalyses] = {0, 0};
+        for (int a = 0; a < numAnalyses; ++a) {
+            frameOffset[a] = frameSize / 2 - analyses[a].geometry.windowSize / 2;
+        }
         
-        if (windowSize <= 0 || hopSize <= 0) {
-            emit calculationError("Parâmetros inválidos");
-            m_isCalculating = false;
-            return;
+        // Tiles do nível anterior disponíveis para pooling
+        for (const SpectrogramTile &source : m_sources) {
+            if (level > 0 && source.level == level - 1 && source.analysis >= 0 &&
+                source.analysis < numAnalyses &&
+                source.numBins == analyses[source.analysis].geometry.numBins()) {
+                analyses[source.analysis].sources.insert(source.index, source);
+            }
         }
+        const int numChildTiles = level > 0 ? geometry.numTiles(level - 1) : 0;
         
-        // Ajustar FFT size para próxima potência de 2 acima do windowSize
-        int fftSize = nextPowerOfTwo(windowSize);
+        // Preparar os tiles pedidos: as análises de um mesmo índice ficam
+        // consecutivas
+        QVector<TileJob> jobs;
+        for (int tileIndex : m_tiles) {
+            if (tileIndex < 0 || tileIndex >= geometry.numTiles(level)) {
+                continue;
+            }
+            for (int a = 0; a < numAnalyses; ++a) {
+                const int numBins = analyses[a].geometry.numBins();
+                TileJob job;
+                job.tile.level = level;
+                job.tile.index = tileIndex;
+                job.tile.analysis = a;
+                job.tile.numColumns = std::min(TileFrames, geometry.numColumns(level) - tileIndex * TileFrames);
+                job.tile.numBins = numBins;
+                job.tile.db.resize(job.tile.numColumns * numBins);
+                
+                // Pooling possível quando os dois filhos existentes foram fornecidos
+                const QHash<int, SpectrogramTile> &sources = analyses[a].sources;
+                int child = 2 * tileIndex;
+                job.pooled = level > 0 && sources.contains(child) &&
+                             (child + 1 >= numChildTiles || sources.contains(child + 1));
+                jobs.append(job);
+            }
+        }
         
-        // Número de frames
-        int numFrames = (numSamples - windowSize) / hopSize + 1;
-        if (numFrames <= 0) {
-            emit calculationError("Áudio muito curto");
-            m_isCalculating = false;
+        if (jobs.isEmpty()) {
+            finishRequest();
+            emit calculationProgress(generation, 100);
+            emit calculationFinished(generation);
             return;
         }
         
-        // Número de bins de frequência
-        int numFreqBins = fftSize / 2 + 1;
-        
-        // Calcular limites de frequência em bins
-        int minBin = static_cast<int>(m_params.minFrequency * fftSize / sampleRate);
-        int maxBin = static_cast<int>(m_params.maxFrequency * fftSize / sampleRate);
-        minBin = std::max(0, std::min(minBin, numFreqBins - 1));
-        maxBin = std::max(minBin + 1, std::min(maxBin, numFreqBins));
-        int numDisplayBins = maxBin - minBin;
-        
-        // Criar imagem do espectrograma
-        QImage spectrogram(numFrames, numDisplayBins, QImage::Format_RGB32);
-        
-        // Matriz para armazenar magnitudes
-        QVector<QVector<float>> magnitudes(numFrames);
+        // Tiles já gravados no cache em disco (mesmo conteúdo e parâmetros);
+        // sem chave (impressão digital ainda em cálculo) o cache é ignorado
+        SpectrogramDiskCache &diskCache = SpectrogramDiskCache::instance();
+        const QString contentKey = m_audioFile->getContentKey();
+        QtConcurrent::blockingMap(m_threadPool, jobs, [&](TileJob &job) {
+            SpectrogramTile cached;
+            if (diskCache.load(contentKey, analyses[job.tile.analysis].paramsKey,
+                               job.tile.level, job.tile.index, cached) &&
+                cached.numColumns == job.tile.numColumns && cached.numBins == job.tile.numBins) {
+                cached.analysis = job.tile.analysis;
+                job.tile = cached;
+                job.fromDisk = true;
+                job.complete = true;
+                emit tileReady(generation, job.tile);
+            }
+        });
         
-        // Calcular FFT para cada frame
-        for (int frameIdx = 0; frameIdx < numFrames; ++frameIdx) {
-            if (m_cancelRequested) {
-                m_isCalculating = false;
+        // Níveis > 0: coluna c do pai = pooling das colunas 2c e 2c + 1 do
+        // nível anterior, sem nenhuma FFT
+        QtConcurrent::blockingMap(m_threadPool, jobs, [&](TileJob &job) {
+            if (!job.pooled || job.fromDisk) {
                 return;
             }
-            
-            // Progresso
-            if (frameIdx % 100 == 0) {
-                int progress = (frameIdx * 100) / numFrames;
-                emit calculationProgress(progress);
-            }
-            
-            // Extrair frame
-            int frameSample = startSample + frameIdx * hopSize;
-            QVector<float> frame(windowSize);
-            for (int i = 0; i < windowSize && (frameSample + i) < endSample; ++i) {
-                frame[i] = samples[frameSample + i];
-            }
-            
-            // Aplicar janela
-            frame = applyWindow(frame, m_params.windowType);
-            
-            // Pré-ênfase (opcional)
-            if (m_params.preEmphasis) {
-                for (int i = frame.size() - 1; i > 0; --i) {
-                    frame[i] = frame[i] - m_params.preEmphasisFactor * frame[i - 1];
+            SpectrogramTile &tile = job.tile;
+            const QHash<int, SpectrogramTile> &sources = analyses[tile.analysis].sources;
+            const int numBins = tile.numBins;
+            float minDb = std::numeric_limits<float>::max();
+            float maxDb = std::numeric_limits<float>::lowest();
+            for (int c = 0; c < tile.numColumns; ++c) {
+                int childColumn = tile.index * TileFrames * 2 + 2 * c;
+                float *dst = tile.db.data() + c * numBins;
+                int count = 0;
+                for (int k = 0; k < 2; ++k) {
+                    int column = childColumn + k;
+                    auto source = sources.constFind(column / TileFrames);
+                    int local = column % TileFrames;
+                    if (source == sources.constEnd() || local >= source->numColumns) {
+                        continue;
+                    }
+                    poolColumn(dst, source->column(local), numBins, count == 0, pooling);
+                    minDb = std::min(minDb, source->minDb);
+                    maxDb = std::max(maxDb, source->maxDb);
+                    ++count;
                 }
+                finishPool(dst, numBins, count, pooling);
             }
-            
-            // Zero-padding para FFT size (potência de 2)
-            while (frame.size() < fftSize) {
-                frame.append(0.0f);
+            tile.minDb = minDb;
+            tile.maxDb = maxDb;
+            job.complete = true;
+            emit tileReady(generation, tile);
+        });
+        
+        // Demais tiles: FFTs divididas em blocos de colunas processados pelo
+        // pool de threads. Vários blocos por thread equilibram a carga. Um
+        // bloco cobre todas as análises do mesmo índice de tile, de modo que
+        // cada frame é lido uma única vez.
+        QVector<QVector<int>> fftGroups;
+        int totalColumns = 0;
+        for (int j = 0; j < jobs.size(); ++j) {
+            if (jobs[j].pooled || jobs[j].fromDisk) {
+                continue;
             }
-            
-            // Computar FFT
-            QVector<std::complex<float>> fftResult = computeFFT(frame);
-            
-            // Calcular magnitude (em dB)
-            magnitudes[frameIdx].resize(numDisplayBins);
-            for (int bin = 0; bin < numDisplayBins; ++bin) {
-                int fftBin = minBin + bin;
-                float magnitude = std::abs(fftResult[fftBin]);
-                float magnitudeDb = 20.0f * std::log10(magnitude + 1e-10f);
-                magnitudes[frameIdx][bin] = magnitudeDb;
+            if (fftGroups.isEmpty() || jobs[fftGroups.last().first()].tile.index != jobs[j].tile.index) {
+                fftGroups.append(QVector<int>());
+                totalColumns += jobs[j].tile.numColumns;
             }
+            fftGroups.last().append(j);
+        }
+        
+        // Sinal decimado com filtro anti-aliasing; calculado uma vez por
+        // arquivo e fator e reaproveitado nos cálculos seguintes. Em fluxo,
+        // cada thread lê com o leitor do seu workspace (buffer de janela +
+        // hop); o primeiro erro de abertura ou leitura encerra o cálculo.
+        QVector<float> samples;
+        const QString filePath = m_audioFile->getFilePath();
+        const int streamCapacity = frameSize + hopSize + 1;
+        if (totalColumns > 0 && !streaming) {
+            samples = m_audioFile->getDecimatedSamples(geometry.downsampleFactor);
         }
+        std::atomic<bool> streamFailed(false);
+        QMutex streamErrorMutex;
+        QString streamError;
+        auto reportStreamError = [&](const QString &message) {
+            QMutexLocker locker(&streamErrorMutex);
+            if (!streamFailed.exchange(true)) {
+                streamError = message;
+            }
+        };
+        int numThreads = std::max(1, m_threadPool->maxThreadCount());
+        int chunkSize = std::max(16, std::min(TileFrames, totalColumns / (numThreads * 4)));
         
-        // Encontrar min/max para normalização
-        float minMag = std::numeric_limits<float>::max();
-        float maxMag = std::numeric_limits<float>::lowest();
-        for (const auto &frame : magnitudes) {
-            for (float mag : frame) {
-                minMag = std::min(minMag, mag);
-                maxMag = std::max(maxMag, mag);
+        // Blocos na ordem dos tiles pedidos (a visualização pede primeiro os
+        // visíveis); cada tile é entregue assim que seu último bloco termina
+        QVector<ColumnChunk> chunks;
+        std::unique_ptr<std::atomic<int>[]> pendingChunks(new std::atomic<int>[jobs.size()]);
+        for (int j = 0; j < jobs.size(); ++j) {
+            pendingChunks[j] = 0;
+        }
+        for (const QVector<int> &group : fftGroups) {
+            const int numColumns = jobs[group.first()].tile.numColumns;
+            const int firstChunk = chunks.size();
+            for (int begin = 0; begin < numColumns; begin += chunkSize) {
+                ColumnChunk chunk;
+                for (int j : group) {
+                    chunk.job[jobs[j].tile.analysis] = j;
+                    ++pendingChunks[j];
+                }
+                chunk.begin = begin;
+                chunk.end = std::min(begin + chunkSize, numColumns);
+                chunks.append(chunk);
             }
+            for (int j : group) {
+                jobs[j].firstChunk = firstChunk;
+                jobs[j].numChunks = chunks.size() - firstChunk;
+            }
+        }
+        
+        // Níveis com mais de MaxFramesPerColumn frames por coluna: primeiro
+        // uma prévia com no máximo MaxFramesPerColumn FFTs por coluna
+        // (entregue como SpectrogramTile::preview), depois o tile completo,
+        // com o pooling de todos os frames da coluna. Só o completo vai
+        // para os caches; ele substitui a prévia na visualização.
+        const bool needsPreview = framesPerColumn > MaxFramesPerColumn;
+        const int firstPass = needsPreview ? 0 : 1;
+        qint64 totalWork = 0;       // Em FFTs, somando as passadas
+        for (int pass = firstPass; pass < 2; ++pass) {
+            int maxSubFrames = pass == 0 ? static_cast<int>(MaxFramesPerColumn) : framesPerColumn;
+            totalWork += static_cast<qint64>(totalColumns) * std::min(framesPerColumn, maxSubFrames);
         }
         
-        // Aplicar faixa dinâmica
-        float threshold = maxMag - m_params.dynamicRange;
+        TileJob *jobData = jobs.data();
+        const ColumnChunk *chunkData = chunks.constData();
+        std::atomic<qint64> workDone(0);
         
-        // Preencher imagem
-        for (int x = 0; x < numFrames; ++x) {
-            for (int y = 0; y < numDisplayBins; ++y) {
-                float mag = magnitudes[x][y];
+        for (int pass = firstPass; pass < 2 && !isObsolete(generation) && !streamFailed; ++pass) {
+            const bool previewPass = pass == 0;
+            const int maxSubFrames = previewPass ? static_cast<int>(MaxFramesPerColumn) : framesPerColumn;
+            
+            // Nova passada: contadores de blocos e extremos zerados; os dB da
+            // prévia entregue são compartilhados com o sinal e desacoplados aqui,
+            // antes que as threads escrevam nos tiles
+            for (int j = 0; j < jobs.size(); ++j) {
+                pendingChunks[j] = jobs[j].pooled || jobs[j].fromDisk ? 0 : jobs[j].numChunks;
+                if (!previewPass && needsPreview && pendingChunks[j] > 0) {
+                    jobs[j].tile.db.detach();
+                }
+            }
+            for (ColumnChunk &chunk : chunks) {
+                std::fill(chunk.minDb, chunk.minDb + MaxAnalyses, std::numeric_limits<float>::max());
+                std::fill(chunk.maxDb, chunk.maxDb + MaxAnalyses, std::numeric_limits<float>::lowest());
+            }
+            
+            QtConcurrent::blockingMap(m_threadPool, chunks, [&](ColumnChunk &chunk) {
+                // Buffers de trabalho reutilizados por cada thread do pool
+                FrameWorkspace &ws = localWorkspace(frameSize, analyses, numAnalyses);
+                float *frame = ws.frame.data();
                 
-                // Normalizar com faixa dinâmica
-                float normalized = (mag - threshold) / m_params.dynamicRange;
-                normalized = std::max(0.0f, std::min(1.0f, normalized));
+                AudioStreamReader *reader = nullptr;
+                if (streaming) {
+                    reader = &localReader(ws, filePath, geometry.downsampleFactor, streamCapacity);
+                    if (!reader->isOpen()) {
+                        reportStreamError(reader->getLastError());
+                        return;
+                    }
+                }
                 
-                // Converter para cor
-                QColor color = valueToColor(normalized, m_params.colorMap, m_params.dynamicRange);
+                int tileIndex = 0;
+                for (int a = 0; a < numAnalyses; ++a) {
+                    if (chunk.job[a] >= 0) {
+                        tileIndex = jobData[chunk.job[a]].tile.index;
+                    }
+                }
                 
-                // Inverter Y (frequências baixas embaixo)
-                spectrogram.setPixelColor(x, numDisplayBins - 1 - y, color);
-            }
+                for (int c = chunk.begin; c < chunk.end; ++c) {
+                    if (isObsolete(generation) || streamFailed) {
+                        return;
+                    }
+                    
+                    // Frames base cobertos pela coluna: todos, ou na prévia no
+                    // máximo MaxFramesPerColumn deles, distribuídos uniformemente
+                    int firstFrame = (tileIndex * TileFrames + c) * framesPerColumn;
+                    int spanFrames = std::min(framesPerColumn, geometry.numFrames - firstFrame);
+                    int numSubFrames = std::min(spanFrames, maxSubFrames);
+                    
+                    for (int sub = 0; sub < numSubFrames; ++sub) {
+                        int frameIdx = firstFrame + ((2 * sub + 1) * spanFrames) / (2 * numSubFrames);
+                        
+                        // Extrair frame centrado em (frameIdx + 0.5) * hop, mais a
+                        // amostra anterior usada pela pré-ênfase
+                        qint64 frameStart = static_cast<qint64>(frameIdx) * hopSize + hopSize / 2 - frameSize / 2;
+                        if (reader) {
+                            if (!reader->read(frameStart - 1, frameSize + 1, frame)) {
+                                reportStreamError(reader->getLastError());
+                                return;
+                            }
+                        } else {
+                            readSamples(samples, frameStart - 1, frameSize + 1, frame);
+                        }
+                        
+                        for (int a = 0; a < numAnalyses; ++a) {
+                            if (chunk.job[a] < 0) {
+                                continue;
+                            }
+                            const AnalysisSetup &analysis = analyses[a];
+                            const Geometry &analysisGeometry = analysis.geometry;
+                            const int numBins = analysisGeometry.numBins();
+                            SpectrogramTile &tile = jobData[chunk.job[a]].tile;
+                            float *column = tile.db.data() + c * numBins;
+                            float *spectrumDb = ws.spectrumDb[a].data();
+                            FFTProcessor &fft = *ws.fft[a];
+                            
+                            // Pré-ênfase (opcional), janela e zero-padding até fftSize
+                            prepareFrame(frame + frameOffset[a], analysis.window.constData(),
+                                         analysisGeometry.windowSize, preEmphasis, fft.input(),
+                                         analysisGeometry.fftSize);
+                            
+                            // Computar FFT
+                            fft.execute();
+                            const std::complex<float> *spectrum = fft.output();
+                            
+                            // Potência em dB apenas dos bins exibidos (minBin..maxBin),
+                            // acompanhando os extremos do bloco
+                            SpectrumKernels::powerToDb(spectrum + analysisGeometry.minBin, numBins,
+                                                       analysis.referenceDb, spectrumDb,
+                                                       chunk.minDb[a], chunk.maxDb[a]);
+                            poolColumn(column, spectrumDb, numBins, sub == 0, pooling);
+                        }
+                    }
+                    for (int a = 0; a < numAnalyses; ++a) {
+                        if (chunk.job[a] >= 0) {
+                            SpectrogramTile &tile = jobData[chunk.job[a]].tile;
+                            finishPool(tile.db.data() + c * tile.numBins, tile.numBins, numSubFrames, pooling);
+                        }
+                    }
+                }
+                
+                // Último bloco do tile: publicar sem esperar os demais tiles
+                for (int a = 0; a < numAnalyses; ++a) {
+                    const int j = chunk.job[a];
+                    if (j < 0 || pendingChunks[j].fetch_sub(1) != 1) {
+                        continue;
+                    }
+                    TileJob &job = jobData[j];
+                    job.tile.minDb = std::numeric_limits<float>::max();
+                    job.tile.maxDb = std::numeric_limits<float>::lowest();
+                    for (int k = job.firstChunk; k < job.firstChunk + job.numChunks; ++k) {
+                        job.tile.minDb = std::min(job.tile.minDb, chunkData[k].minDb[a]);
+                        job.tile.maxDb = std::max(job.tile.maxDb, chunkData[k].maxDb[a]);
+                    }
+                    if (previewPass) {
+                        SpectrogramTile preview = job.tile;
+                        preview.preview = true;
+                        emit tileReady(generation, preview);
+                    } else {
+                        job.complete = true;
+                        emit tileReady(generation, job.tile);
+                    }
+                }
+                
+                // Progresso (FFTs das duas passadas): emitido apenas quando o
+                // percentual muda
+                qint64 work = static_cast<qint64>(chunk.end - chunk.begin) * std::min(framesPerColumn, maxSubFrames);
+                qint64 done = workDone.fetch_add(work) + work;
+                int before = static_cast<int>(((done - work) * 100) / totalWork);
+                int after = static_cast<int>((done * 100) / totalWork);
+                if (after != before) {
+                    emit calculationProgress(generation, after);
+                }
+            });
+        }
+        
+        bool cancelled = isObsolete(generation);
+        finishRequest();
+        if (streamFailed && !cancelled) {
+            emit calculationError(generation, streamError);
+        } else if (cancelled) {
+            emit calculationCancelled(generation);
+        } else {
+            emit calculationProgress(generation, 100);
+            emit calculationFinished(generation);
         }
         
-        emit calculationProgress(100);
-        emit calculationFinished(spectrogram);
+        // Gravar em disco os tiles novos já entregues (inclusive os
+        // concluídos antes de um cancelamento)
+        QtConcurrent::blockingMap(m_threadPool, jobs, [&](TileJob &job) {
+            if (job.complete && !job.fromDisk) {
+                diskCache.store(contentKey, analyses[job.tile.analysis].paramsKey, job.tile);
+            }
+        });
         
     } catch (const std::exception &e) {
-        emit calculationError(QString("Erro no cálculo: %1").arg(e.what()));
+        finishRequest();
+        emit calculationError(generation, QString("Erro no cálculo: %1").arg(e.what()));
+    }
+}
+
+SpectrogramTile SpectrogramCalculator::computePreview(const AudioFile &audioFile, const Parameters &params,
+                                                     double startTime, double duration, int maxColumns,
+                                                     const std::function<bool()> &isCancelled)
+{
+    SpectrogramTile tile;
+    const Geometry geometry = computeGeometry(params, audioFile.getSampleRate(),
+                                              audioFile.getNumSamples());
+    if (!geometry.isValid() || duration <= 0.0 || maxColumns <= 0) {
+        return tile;
     }
     
-    m_isCalculating = false;
+    const int windowSize = geometry.windowSize;
+    const int fftSize = geometry.fftSize;
+    const int minBin = geometry.minBin;
+    const int numBins = geometry.numBins();
+    const int factor = geometry.downsampleFactor;
+    
+    // Passo grosso: uma FFT por coluna, limitado pelo orçamento de FFT
+    const int numColumns = std::max(1, std::min(maxColumns, PreviewFftBudget / fftSize));
+    const double columnSamples = duration * geometry.sampleRate / numColumns;
+    const double firstCenter = startTime * geometry.sampleRate + columnSamples / 2.0;
+    
+    const QVector<float> window = windowTable(params.windowType, windowSize);
+    const float preEmphasis = params.preEmphasis ? static_cast<float>(params.preEmphasisFactor) : 0.0f;
+    const float referenceDb = referenceLevelDb(window);
+    
+    // Sem amostras em memória: apenas as janelas dos frames, lidas do arquivo
+    const QVector<float> &samples = audioFile.getSamples();
+    std::unique_ptr<AudioStreamReader> reader;
+    if (samples.isEmpty()) {
+        reader = std::make_unique<AudioStreamReader>(audioFile.getFilePath(), 0, factor, windowSize + 1);
+        if (!reader->isOpen()) {
+            qWarning() << "SpectrogramCalculator: falha ao abrir o arquivo da prévia:" << reader->getLastError();
+            return tile;
+        }
+    }
+    
+    FFTProcessor fft(fftSize);
+    QVector<float> frame(windowSize + 1);
+    QVector<float> scratch;
+    
+    tile.numColumns = numColumns;
+    tile.numBins = numBins;
+    tile.db.resize(numColumns * numBins);
+    tile.minDb = std::numeric_limits<float>::max();
+    tile.maxDb = std::numeric_limits<float>::lowest();
+    
+    for (int c = 0; c < numColumns; ++c) {
+        if (isCancelled && isCancelled()) {
+            return SpectrogramTile();
+        }
+        
+        qint64 center = static_cast<qint64>(firstCenter + c * columnSamples);
+        qint64 frameStart = center - windowSize / 2;
+        if (reader) {
+            // Leitura falha: sem prévia, em vez de FFT sobre o frame anterior
+            if (!reader->read(frameStart - 1, windowSize + 1, frame.data())) {
+                qWarning() << "SpectrogramCalculator: falha na leitura da prévia:" << reader->getLastError();
+                return SpectrogramTile();
+            }
+        } else {
+            readDecimatedSamples(samples, factor, frameStart - 1, windowSize + 1, frame.data(), scratch);
+        }
+        
+        prepareFrame(frame.constData(), window.constData(), windowSize, preEmphasis, fft.input(), fftSize);
+        fft.execute();
+        SpectrumKernels::powerToDb(fft.output() + minBin, numBins, referenceDb,
+                                   tile.db.data() + c * numBins, tile.minDb, tile.maxDb);
+    }
+    return tile;
 }
 
-QVector<float> SpectrogramCalculator::applyWindow(const QVector<float> &frame, const QString &windowType)
+QVector<float> SpectrogramCalculator::windowTable(WindowType windowType, int N)
 {
-    QVector<float> windowed = frame;
-    int N = frame.size();
+    QMutexLocker locker(&s_windowMutex);
+    
+    quint64 key = (static_cast<quint64>(windowType) << 32) | static_cast<quint32>(N);
+    auto it = s_windowCache.constFind(key);
+    if (it != s_windowCache.constEnd()) {
+        return it.value();
+    }
     
+    QVector<float> window(N, 1.0f);
+    double denominator = std::max(1, N - 1);
     for (int i = 0; i < N; ++i) {
-        float w = 1.0f;
+        double phase = 2.0 * M_PI * i / denominator;
         
-        if (windowType == "Hamming") {
-            w = 0.54f - 0.46f * std::cos(2.0f * M_PI * i / (N - 1));
-        } else if (windowType == "Hanning") {
-            w = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (N - 1)));
-        } else if (windowType == "Blackman") {
-            w = 0.42f - 0.5f * std::cos(2.0f * M_PI * i / (N - 1)) 
-                + 0.08f * std::cos(4.0f * M_PI * i / (N - 1));
-        }
-        // "Rectangular" não aplica janela
-        
-        windowed[i] *= w;
+        if (windowType == Hamming) {
+            window[i] = static_cast<float>(0.54 - 0.46 * std::cos(phase));
+        } else if (windowType == Hanning) {
+            window[i] = static_cast<float>(0.5 * (1.0 - std::cos(phase)));
+        } else if (windowType == Blackman) {
+            window[i] = static_cast<float>(0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+        }
+        // Rectangular não aplica janela
+    }
+    
+    s_windowCache.insert(key, window);
+    return window;
+}
+
+QString SpectrogramCalculator::parametersKey(const Parameters &params)
+{
+    // Inclui as constantes que definem o conteúdo dos tiles e uma versão do
+    // algoritmo, para invalidar entradas antigas do cache em disco
+    return QString("v1_%1_%2_%3_%4_%5_%6_%7_%8_%9_%10_%11")
+        .arg(TileFrames)
+        .arg(MaxFramesPerColumn)
+        .arg(params.timeStep, 0, 'f', 6)
+        .arg(params.timeWindow, 0, 'f', 6)
+        .arg(params.fftSize)
+        .arg(static_cast<int>(params.windowType))
+        .arg(params.minFrequency, 0, 'f', 1)
+        .arg(params.maxFrequency, 0, 'f', 1)
+        .arg(params.preEmphasis ? 1 : 0)
+        .arg(params.preEmphasisFactor, 0, 'f', 3)
+        .arg(static_cast<int>(params.pooling));
+}
+
+SpectrogramCalculator::WindowType SpectrogramCalculator::windowTypeFromName(const QString &name)
+{
+    if (name == "Hanning") {
+        return Hanning;
+    } else if (name == "Blackman") {
+        return Blackman;
+    } else if (name == "Rectangular") {
+        return Rectangular;
+    }
+    return Hamming;
+}
+
+QImage SpectrogramCalculator::quantize(const SpectrogramTile &tile, const FrequencyRemap &remap)
+{
+    const bool remapped = !remap.isNull() && remap.numBins == tile.numBins;
+    QImage image(tile.numColumns, remapped ? remap.numRows : tile.numBins, QImage::Format_Indexed8);
+    if (image.isNull()) {
+        return image;
+    }
+    
+    if (remapped) {
+        // Linha y = linha da escala numRows - 1 - y, reamostrada da coluna
+        const int numRows = remap.numRows;
+        for (int y = 0; y < numRows; ++y) {
+            uchar *line = image.scanLine(y);
+            const int row = numRows - 1 - y;
+            for (int x = 0; x < tile.numColumns; ++x) {
+                line[x] = quantizeDb(remap.value(tile.column(x), row));
+            }
+        }
+        return image;
     }
     
-    return windowed;
+    // Linha a linha: escrita contígua em cada scanLine. A linha y corresponde
+    // ao bin numBins - 1 - y (frequências baixas embaixo).
+    const float *db = tile.db.constData();
+    const int numBins = tile.numBins;
+    for (int y = 0; y < numBins; ++y) {
+        uchar *line = image.scanLine(y);
+        const float *src = db + (numBins - 1 - y);
+        for (int x = 0; x < tile.numColumns; ++x) {
+            line[x] = quantizeDb(src[x * numBins]);
+        }
+    }
+    return image;
 }
 
-QVector<std::complex<float>> SpectrogramCalculator::computeFFT(const QVector<float> &frame)
+QImage SpectrogramCalculator::quantize(const SpectrogramTile &tile, const QByteArray &levels,
+                                       const FrequencyRemap &remap)
 {
-    int N = frame.size();
-    QVector<std::complex<float>> result(N);
+    const int numBins = tile.numBins;
+    if (levels.size() < static_cast<qsizetype>(tile.numColumns) * numBins) {
+        return QImage();
+    }
+    const bool remapped = !remap.isNull() && remap.numBins == numBins;
+    QImage image(tile.numColumns, remapped ? remap.numRows : numBins, QImage::Format_Indexed8);
+    if (image.isNull()) {
+        return image;
+    }
     
-    // FFT simples (DFT) - pode ser otimizado com FFT real
-    for (int k = 0; k < N; ++k) {
-        std::complex<float> sum(0.0f, 0.0f);
-        for (int n = 0; n < N; ++n) {
-            float angle = -2.0f * M_PI * k * n / N;
-            sum += frame[n] * std::complex<float>(std::cos(angle), std::sin(angle));
+    const quint8 *data = reinterpret_cast<const quint8 *>(levels.constData());
+    if (remapped) {
+        const int numRows = remap.numRows;
+        for (int y = 0; y < numRows; ++y) {
+            uchar *line = image.scanLine(y);
+            const int row = numRows - 1 - y;
+            for (int x = 0; x < tile.numColumns; ++x) {
+                line[x] = remap.level(data + x * numBins, row);
+            }
         }
-        result[k] = sum;
+        return image;
     }
     
+    // Transposição direta dos níveis (bin numBins - 1 - y na linha y)
+    for (int y = 0; y < numBins; ++y) {
+        uchar *line = image.scanLine(y);
+        const quint8 *src = data + (numBins - 1 - y);
+        for (int x = 0; x < tile.numColumns; ++x) {
+            line[x] = src[x * numBins];
+        }
+    }
+    return image;
+}
+
+quint8 SpectrogramCalculator::quantizeDb(float db)
+{
+    float level = std::round((QuantizedLevels - 1) + db / QuantizationStepDb);
+    return static_cast<quint8>(std::max(0.0f, std::min(static_cast<float>(QuantizedLevels - 1), level)));
+}
+
+float SpectrogramCalculator::dequantizeDb(quint8 level)
+{
+    return (static_cast<int>(level) - (QuantizedLevels - 1)) * QuantizationStepDb;
+}
+
+QVector<QRgb> SpectrogramCalculator::palette(double dynamicRange, ColorMap colorMap)
+{
+    // Nível -> dB -> posição na faixa dinâmica -> cor; com 0 dB = fundo de
+    // escala no topo da tabela
+    const QVector<QRgb> &table = colorTable(colorMap);
+    const double range = std::max(1.0, dynamicRange);
+    QVector<QRgb> result(QuantizedLevels);
+    for (int level = 0; level < QuantizedLevels; ++level) {
+        double value = (dequantizeDb(static_cast<quint8>(level)) + range) / range;
+        int index = static_cast<int>(value * (ColorTableSize - 1));
+        result[level] = table[std::max(0, std::min(ColorTableSize - 1, index))];
+    }
     return result;
 }
 
-QColor SpectrogramCalculator::valueToColor(float value, const QString &colorMap, float dynamicRange)
+SpectrogramCalculator::ColorMap SpectrogramCalculator::colorMapFromName(const QString &name)
+{
+    if (name == "Jet") {
+        return Jet;
+    } else if (name == "Hot") {
+        return Hot;
+    } else if (name == "Cool") {
+        return Cool;
+    } else if (name == "Viridis") {
+        return Viridis;
+    }
+    return Grayscale;
+}
+
+const QVector<QRgb> &SpectrogramCalculator::colorTable(ColorMap colorMap)
+{
+    // Construídas uma vez (inicialização de estáticos é thread-safe)
+    static const QVector<QVector<QRgb>> tables = [] {
+        QVector<QVector<QRgb>> result;
+        for (int map = Grayscale; map <= Viridis; ++map) {
+            QVector<QRgb> table(ColorTableSize);
+            for (int i = 0; i < ColorTableSize; ++i) {
+                table[i] = valueToColor(static_cast<float>(i) / (ColorTableSize - 1),
+                                        static_cast<ColorMap>(map));
+            }
+            result.append(table);
+        }
+        return result;
+    }();
+    
+    return tables[std::max(0, std::min(static_cast<int>(colorMap), static_cast<int>(tables.size()) - 1))];
+}
+
+QRgb SpectrogramCalculator::valueToColor(float value, ColorMap colorMap)
 {
     value = std::max(0.0f, std::min(1.0f, value));
     
-    if (colorMap == "Grayscale") {
-        int gray = static_cast<int>(value * 255);
-        return QColor(gray, gray, gray);
-    } else if (colorMap == "Jet") {
+    if (colorMap == Jet) {
         // Mapa Jet: azul -> ciano -> verde -> amarelo -> vermelho
         if (value < 0.25f) {
             float t = value / 0.25f;
-            return QColor(0, static_cast<int>(t * 255), 255);
+            return qRgb(0, static_cast<int>(t * 255), 255);
         } else if (value < 0.5f) {
             float t = (value - 0.25f) / 0.25f;
-            return QColor(0, 255, static_cast<int>((1.0f - t) * 255));
+            return qRgb(0, 255, static_cast<int>((1.0f - t) * 255));
         } else if (value < 0.75f) {
             float t = (value - 0.5f) / 0.25f;
-            return QColor(static_cast<int>(t * 255), 255, 0);
+            return qRgb(static_cast<int>(t * 255), 255, 0);
         } else {
             float t = (value - 0.75f) / 0.25f;
-            return QColor(255, static_cast<int>((1.0f - t) * 255), 0);
+            return qRgb(255, static_cast<int>((1.0f - t) * 255), 0);
         }
-    } else if (colorMap == "Hot") {
+    } else if (colorMap == Hot) {
         // Mapa Hot: preto -> vermelho -> amarelo -> branco
         if (value < 0.33f) {
             float t = value / 0.33f;
-            return QColor(static_cast<int>(t * 255), 0, 0);
+            return qRgb(static_cast<int>(t * 255), 0, 0);
         } else if (value < 0.66f) {
             float t = (value - 0.33f) / 0.33f;
-            return QColor(255, static_cast<int>(t * 255), 0);
+            return qRgb(255, static_cast<int>(t * 255), 0);
         } else {
             float t = (value - 0.66f) / 0.34f;
-            return QColor(255, 255, static_cast<int>(t * 255));
+            return qRgb(255, 255, static_cast<int>(t * 255));
         }
-    } else if (colorMap == "Cool") {
+    } else if (colorMap == Cool) {
         // Mapa Cool: ciano -> magenta
-        return QColor(static_cast<int>(value * 255), static_cast<int>((1.0f - value) * 255), 255);
-    } else if (colorMap == "Viridis") {
+        return qRgb(static_cast<int>(value * 255), static_cast<int>((1.0f - value) * 255), 255);
+    } else if (colorMap == Viridis) {
         // Aproximação do Viridis
         if (value < 0.5f) {
             float t = value / 0.5f;
-            return QColor(static_cast<int>(t * 68), static_cast<int>(t * 1 + (1-t) * 0), static_cast<int>(t * 84 + (1-t) * 68));
+            return qRgb(static_cast<int>(t * 68), static_cast<int>(t * 1 + (1-t) * 0), static_cast<int>(t * 84 + (1-t) * 68));
         } else {
             float t = (value - 0.5f) / 0.5f;
-            return QColor(static_cast<int>(t * 253 + (1-t) * 68), static_cast<int>(t * 231 + (1-t) * 1), static_cast<int>(t * 37 + (1-t) * 84));
+            return qRgb(static_cast<int>(t * 253 + (1-t) * 68), static_cast<int>(t * 231 + (1-t) * 1), static_cast<int>(t * 37 + (1-t) * 84));
         }
     }
     
     // Default: Grayscale
     int gray = static_cast<int>(value * 255);
-    return QColor(gray, gray, gray);
+    return qRgb(gray, gray, gray);
 }
 
 int SpectrogramCalculator::nextPowerOfTwo(int n)
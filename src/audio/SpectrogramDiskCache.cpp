@@ -0,0 +1,299 @@
+#include "audio/SpectrogramDiskCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const quint32 kTileMagic = 0x42455354;     // "BEST"
+    const quint32 kTileVersion = 1;
+
+    // Bloco lido por vez para a impressão digital do conteúdo
+    const qint64 kFingerprintBlock = 1024 * 1024;
+
+    // Limite padrão do cache em disco (MB)
+    const int kDefaultMaxSizeMB = 1024;
+
+    struct TileHeader {
+        quint32 magic;
+        quint32 version;
+        qint32 level;
+        qint32 index;
+        qint32 numColumns;
+        qint32 numBins;
+    };
+}
+
+SpectrogramDiskCache& SpectrogramDiskCache::instance()
+{
+    static SpectrogramDiskCache instance;
+    return instance;
+}
+
+SpectrogramDiskCache::SpectrogramDiskCache()
+    : m_totalBytes(-1)
+{
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                  + "/BionoteEchos/spectrogram";
+
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    int maxSizeMB = settings.value("spectrogram/diskCacheMB", kDefaultMaxSizeMB).toInt();
+    m_maxSizeBytes = static_cast<qint64>(std::max(0, maxSizeMB)) * 1024 * 1024;
+}
+
+QString SpectrogramDiskCache::contentFingerprint(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    // Conteúdo inteiro, lido em blocos: qualquer edição muda a chave,
+    // inclusive as que preservam o tamanho do arquivo
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(file.size()));
+    QByteArray block;
+    while (!(block = file.read(kFingerprintBlock)).isEmpty()) {
+        hash.addData(block);
+    }
+    if (file.error() != QFileDevice::NoError) {
+        return QString();
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString SpectrogramDiskCache::fingerprint(const QString &filePath)
+{
+    QFileInfo info(filePath);
+    const QString canonicalPath = info.canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        return QString();
+    }
+    const qint64 size = info.size();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    const QString indexPath = fingerprintIndexPath(canonicalPath);
+
+    // Índice: caminho, tamanho, data de modificação (ms) e impressão digital
+    QFile index(indexPath);
+    if (index.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        const QStringList fields = QString::fromUtf8(index.readAll()).split('\n');
+        if (fields.size() >= 4 && fields[0] == canonicalPath &&
+            fields[1].toLongLong() == size && fields[2].toLongLong() == modified &&
+            !fields[3].isEmpty()) {
+            return fields[3];
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pendingFingerprints.contains(canonicalPath)) {
+            return QString();
+        }
+        m_pendingFingerprints.insert(canonicalPath);
+    }
+
+    // Primeira abertura (ou arquivo alterado): ler o arquivo inteiro fora
+    // do cálculo do espectrograma
+    QThreadPool::globalInstance()->start([this, filePath, canonicalPath, size, modified, indexPath]() {
+        QString key = contentFingerprint(filePath);
+        if (!key.isEmpty()) {
+            QDir().mkpath(QFileInfo(indexPath).absolutePath());
+            QSaveFile file(indexPath);
+            if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                file.write(QString("%1\n%2\n%3\n%4\n")
+                               .arg(canonicalPath).arg(size).arg(modified).arg(key).toUtf8());
+                if (!file.commit()) {
+                    qWarning() << "SpectrogramDiskCache: falha ao gravar" << indexPath;
+                }
+            }
+        }
+        QMutexLocker locker(&m_mutex);
+        m_pendingFingerprints.remove(canonicalPath);
+    });
+    return QString();
+}
+
+QString SpectrogramDiskCache::fingerprintIndexPath(const QString &canonicalPath) const
+{
+    QString name = QString::fromLatin1(
+        QCryptographicHash::hash(canonicalPath.toUtf8(), QCryptographicHash::Sha1).toHex());
+    return QString("%1/fingerprints/%2.key").arg(m_directory, name);
+}
+
+QString SpectrogramDiskCache::tilePath(const QString &contentKey, const QString &parametersKey,
+                                       int level, int index) const
+{
+    QString parametersDir = QString::fromLatin1(
+        QCryptographicHash::hash(parametersKey.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+    return QString("%1/%2/%3/%4_%5.tile")
+        .arg(m_directory, contentKey, parametersDir)
+        .arg(level)
+        .arg(index);
+}
+
+bool SpectrogramDiskCache::load(const QString &contentKey, const QString &parametersKey,
+                                int level, int index, SpectrogramTile &tile)
+{
+    if (contentKey.isEmpty() || m_maxSizeBytes <= 0) {
+        return false;
+    }
+
+    QFile file(tilePath(contentKey, parametersKey, level, index));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 size = file.size();
+    if (size < static_cast<qint64>(sizeof(TileHeader))) {
+        return false;
+    }
+
+    uchar *data = file.map(0, size);
+    if (!data) {
+        return false;
+    }
+
+    TileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    qint64 expected = static_cast<qint64>(sizeof(TileHeader)) +
+                      static_cast<qint64>(header.numColumns) * header.numBins * sizeof(float);
+    bool valid = header.magic == kTileMagic && header.version == kTileVersion &&
+                 header.level == level && header.index == index &&
+                 header.numColumns > 0 && header.numBins > 0 && size == expected;
+
+    if (valid) {
+        tile.level = header.level;
+        tile.index = header.index;
+        tile.numColumns = header.numColumns;
+        tile.numBins = header.numBins;
+        tile.db.resize(header.numColumns * header.numBins);
+        std::memcpy(tile.db.data(), data + sizeof(TileHeader), tile.db.size() * sizeof(float));
+        auto bounds = std::minmax_element(tile.db.constBegin(), tile.db.constEnd());
+        tile.minDb = *bounds.first;
+        tile.maxDb = *bounds.second;
+    }
+    file.unmap(data);
+
+    // A data de modificação marca o último uso (ordem de remoção)
+    if (valid) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return valid;
+}
+
+void SpectrogramDiskCache::store(const QString &contentKey, const QString &parametersKey,
+                                 const SpectrogramTile &tile)
+{
+    if (contentKey.isEmpty() || tile.isNull() || m_maxSizeBytes <= 0) {
+        return;
+    }
+
+    QString path = tilePath(contentKey, parametersKey, tile.level, tile.index);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    TileHeader header;
+    header.magic = kTileMagic;
+    header.version = kTileVersion;
+    header.level = tile.level;
+    header.index = tile.index;
+    header.numColumns = tile.numColumns;
+    header.numBins = tile.numBins;
+
+    qint64 previousSize = QFileInfo(path).exists() ? QFileInfo(path).size() : 0;
+
+    // QSaveFile: o arquivo só aparece completo (renomeado ao final)
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(tile.db.constData()),
+               static_cast<qint64>(tile.db.size()) * sizeof(float));
+    if (!file.commit()) {
+        qWarning() << "SpectrogramDiskCache: falha ao gravar" << path;
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    ensureSizeKnownLocked();
+    m_totalBytes += QFileInfo(path).size() - previousSize;
+    if (m_totalBytes > m_maxSizeBytes) {
+        evictLocked();
+    }
+}
+
+void SpectrogramDiskCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    QDir(m_directory).removeRecursively();
+    m_totalBytes = 0;
+}
+
+void SpectrogramDiskCache::setMaxSizeBytes(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxSizeBytes = std::max<qint64>(0, bytes);
+    ensureSizeKnownLocked();
+    if (m_totalBytes > m_maxSizeBytes) {
+        evictLocked();
+    }
+}
+
+void SpectrogramDiskCache::ensureSizeKnownLocked()
+{
+    if (m_totalBytes >= 0) {
+        return;
+    }
+
+    m_totalBytes = 0;
+    QDirIterator it(m_directory, QStringList() << "*.tile", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        m_totalBytes += it.fileInfo().size();
+    }
+}
+
+void SpectrogramDiskCache::evictLocked()
+{
+    QFileInfoList files;
+    QDirIterator it(m_directory, QStringList() << "*.tile", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        files.append(it.fileInfo());
+    }
+
+    // Remover os usados há mais tempo até ficar 10% abaixo do limite
+    std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+
+    qint64 target = m_maxSizeBytes - m_maxSizeBytes / 10;
+    m_totalBytes = 0;
+    for (const QFileInfo &info : files) {
+        m_totalBytes += info.size();
+    }
+    for (const QFileInfo &info : files) {
+        if (m_totalBytes <= target) {
+            break;
+        }
+        if (QFile::remove(info.absoluteFilePath())) {
+            m_totalBytes -= info.size();
+            // Diretório vazio de parâmetros/conteúdo
+            QDir dir = info.absoluteDir();
+            if (dir.isEmpty()) {
+                dir.rmdir(dir.absolutePath());
+            }
+        }
+    }
+}
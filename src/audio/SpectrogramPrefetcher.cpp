@@ -0,0 +1,291 @@
+#include "audio/SpectrogramPrefetcher.h"
+#include "audio/SpectrogramCache.h"
+#include "models/AudioFile.h"
+#include <QSettings>
+#include <algorithm>
+
+namespace {
+    // Teto padrão de memória dos tiles pré-calculados (MB)
+    const int kDefaultPrefetchMB = 128;
+
+    // Arquivos lembrados como usados recentemente
+    const int kMaxRecentFiles = 5;
+
+    // Vizinhos na lista, de cada lado do arquivo selecionado
+    const int kNeighbourDistance = 2;
+}
+
+SpectrogramPrefetcher::SpectrogramPrefetcher(QObject *parent)
+    : QObject(parent)
+    , m_calculatorThread(nullptr)
+    , m_calculator(nullptr)
+    , m_width(0)
+    , m_currentGeneration(0)
+    , m_isCalculating(false)
+    , m_paused(false)
+    , m_foregroundActive(false)
+{
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    m_maxBytes = static_cast<qint64>(
+        std::max(0, settings.value("spectrogram/prefetchMB", kDefaultPrefetchMB).toInt())) * 1024 * 1024;
+    m_paused = settings.value("spectrogram/prefetchPaused", false).toBool();
+
+    // Uma thread ociosa para as FFTs: o pré-cálculo só usa CPU que o
+    // restante da aplicação não está usando
+    m_threadPool.setMaxThreadCount(1);
+    m_threadPool.setThreadPriority(QThread::IdlePriority);
+
+    m_calculatorThread = new QThread(this);
+    m_calculatorThread->setObjectName("SpectrogramPrefetcherThread");
+
+    m_calculator = new SpectrogramCalculator();
+    m_calculator->setThreadPool(&m_threadPool);
+    m_calculator->moveToThread(m_calculatorThread);
+
+    connect(m_calculator, &SpectrogramCalculator::tileReady,
+            this, &SpectrogramPrefetcher::onTileReady);
+    connect(m_calculator, &SpectrogramCalculator::calculationFinished,
+            this, &SpectrogramPrefetcher::onCalculationDone);
+    connect(m_calculator, &SpectrogramCalculator::calculationCancelled,
+            this, &SpectrogramPrefetcher::onCalculationDone);
+    connect(m_calculator, &SpectrogramCalculator::calculationError,
+            this, [this](quint64 generation, QString) { onCalculationDone(generation); });
+    connect(m_calculator, &SpectrogramCalculator::startCalculationInThread,
+            m_calculator, &SpectrogramCalculator::performCalculation,
+            Qt::QueuedConnection);
+
+    m_calculatorThread->start(QThread::IdlePriority);
+}
+
+SpectrogramPrefetcher::~SpectrogramPrefetcher()
+{
+    m_calculator->cancel();
+    m_calculatorThread->quit();
+    m_calculatorThread->wait();
+    delete m_calculator;
+}
+
+void SpectrogramPrefetcher::setViewport(const SpectrogramCalculator::Parameters &params, int width)
+{
+    if (params != m_params) {
+        stopCurrent();
+    }
+    m_params = params;
+    m_width = width;
+}
+
+void SpectrogramPrefetcher::setMemoryCeilingBytes(qint64 bytes)
+{
+    m_maxBytes = std::max<qint64>(0, bytes);
+    startNext();
+}
+
+void SpectrogramPrefetcher::fileSelected(std::shared_ptr<AudioFile> audioFile,
+                                         const QVector<std::shared_ptr<AudioFile>> &projectFiles)
+{
+    if (!audioFile) {
+        return;
+    }
+
+    // Nova seleção: nova fila. O teto vale para os tiles pré-calculados
+    // ainda no cache, de qualquer seleção
+    stopCurrent();
+    m_queue.clear();
+
+    auto enqueue = [this, &audioFile](const std::shared_ptr<AudioFile> &file) {
+        if (!file || file == audioFile) {
+            return;
+        }
+        for (const std::weak_ptr<AudioFile> &queued : m_queue) {
+            if (queued.lock() == file) {
+                return;
+            }
+        }
+        m_queue.append(file);
+    };
+
+    // Vizinhos na lista, do mais próximo ao mais distante (o seguinte antes
+    // do anterior), depois os usados recentemente
+    int index = static_cast<int>(projectFiles.indexOf(audioFile));
+    if (index >= 0) {
+        for (int distance = 1; distance <= kNeighbourDistance; ++distance) {
+            if (index + distance < projectFiles.size()) {
+                enqueue(projectFiles[index + distance]);
+            }
+            if (index - distance >= 0) {
+                enqueue(projectFiles[index - distance]);
+            }
+        }
+    }
+    for (const std::weak_ptr<AudioFile> &recent : m_recentFiles) {
+        enqueue(recent.lock());
+    }
+
+    // Atualizar a lista de recentes
+    for (int i = static_cast<int>(m_recentFiles.size()) - 1; i >= 0; --i) {
+        std::shared_ptr<AudioFile> recent = m_recentFiles[i].lock();
+        if (!recent || recent == audioFile) {
+            m_recentFiles.remove(i);
+        }
+    }
+    m_recentFiles.prepend(audioFile);
+    if (m_recentFiles.size() > kMaxRecentFiles) {
+        m_recentFiles.resize(kMaxRecentFiles);
+    }
+
+    startNext();
+}
+
+void SpectrogramPrefetcher::setPaused(bool paused)
+{
+    if (paused == m_paused) {
+        return;
+    }
+    m_paused = paused;
+
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    settings.setValue("spectrogram/prefetchPaused", paused);
+
+    if (paused) {
+        stopCurrent();
+    } else {
+        startNext();
+    }
+}
+
+void SpectrogramPrefetcher::setForegroundActive(bool active)
+{
+    if (active == m_foregroundActive) {
+        return;
+    }
+    m_foregroundActive = active;
+
+    // O cálculo interativo tem prioridade: o arquivo em andamento volta
+    // para o início da fila
+    if (active) {
+        stopCurrent();
+    } else {
+        startNext();
+    }
+}
+
+void SpectrogramPrefetcher::onTileReady(quint64 generation, SpectrogramTile tile)
+{
+    std::shared_ptr<AudioFile> audioFile = m_currentFile.lock();
+    // Prévias não são guardadas: o tile completo vem em seguida
+    if (generation != m_currentGeneration || !audioFile || tile.isNull() || tile.preview) {
+        return;
+    }
+
+    SpectrogramCacheKey key;
+    key.fileId = audioFile->getId();
+    key.params = m_currentParams.analysis(tile.analysis);
+    key.level = tile.level;
+    key.index = tile.index;
+
+    SpectrogramCache &cache = SpectrogramCache::instance();
+    cache.insert(key, tile, true);
+
+    // Teto atingido: o arquivo atual não continua
+    if (cache.prefetchedBytes() >= m_maxBytes) {
+        m_calculator->cancel();
+    }
+}
+
+void SpectrogramPrefetcher::onCalculationDone(quint64 generation)
+{
+    if (generation != m_currentGeneration || !m_isCalculating) {
+        return;
+    }
+    m_isCalculating = false;
+    m_currentFile.reset();
+    startNext();
+}
+
+void SpectrogramPrefetcher::stopCurrent()
+{
+    if (!m_isCalculating) {
+        return;
+    }
+
+    // Os tiles já entregues ficam no cache; o restante é pedido de novo
+    // quando o arquivo voltar a ser processado
+    m_calculator->cancel();
+    if (!m_currentFile.expired()) {
+        m_queue.prepend(m_currentFile);
+    }
+    m_currentFile.reset();
+    m_isCalculating = false;
+}
+
+qint64 SpectrogramPrefetcher::prefetchedBytes() const
+{
+    return SpectrogramCache::instance().prefetchedBytes();
+}
+
+int SpectrogramPrefetcher::levelForFile(const SpectrogramCalculator::Geometry &geometry) const
+{
+    // Mesmo critério do SpectrogramWidget para o arquivo inteiro: menor
+    // nível com no máximo ~2 colunas por pixel
+    double columnsPerPixel = static_cast<double>(geometry.numFrames) / std::max(1, m_width);
+    int level = 0;
+    int maxLevel = geometry.maxLevel();
+    while (columnsPerPixel >= 2.0 && level < maxLevel) {
+        columnsPerPixel /= 2.0;
+        ++level;
+    }
+    return level;
+}
+
+void SpectrogramPrefetcher::startNext()
+{
+    if (m_paused || m_foregroundActive || m_isCalculating || m_width <= 0 ||
+        prefetchedBytes() >= m_maxBytes) {
+        return;
+    }
+
+    SpectrogramCache &cache = SpectrogramCache::instance();
+    while (!m_queue.isEmpty()) {
+        std::shared_ptr<AudioFile> audioFile = m_queue.takeFirst().lock();
+        if (!audioFile) {
+            continue;
+        }
+
+        SpectrogramCalculator::Geometry geometry = SpectrogramCalculator::computeGeometry(
+            m_params, audioFile->getSampleRate(), audioFile->getNumSamples());
+        if (!geometry.isValid()) {
+            continue;
+        }
+
+        // Primeira visualização: o arquivo inteiro; apenas os tiles ausentes
+        // (em alguma das análises, na análise dupla)
+        int level = levelForFile(geometry);
+        SpectrogramCacheKey key;
+        key.fileId = audioFile->getId();
+        key.level = level;
+        QVector<int> tiles;
+        for (int index = 0; index < geometry.numTiles(level); ++index) {
+            key.index = index;
+            for (int analysis = 0; analysis < m_params.numAnalyses(); ++analysis) {
+                key.params = m_params.analysis(analysis);
+                if (!cache.containsComplete(key)) {
+                    tiles.append(index);
+                    break;
+                }
+            }
+        }
+        if (tiles.isEmpty()) {
+            continue;
+        }
+
+        quint64 generation = m_calculator->calculate(audioFile, m_params, level, tiles);
+        if (generation == 0) {
+            continue;
+        }
+        m_currentGeneration = generation;
+        m_currentFile = audioFile;
+        m_currentParams = m_params;
+        m_isCalculating = true;
+        return;
+    }
+}
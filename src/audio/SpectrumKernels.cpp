@@ -0,0 +1,237 @@
+#include "audio/SpectrumKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SPECTRUMKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    // 10 * log10(2): converte log2 da potência em dB
+    const float kDbPerLog2 = 3.0102999566f;
+
+    // log2(1 + t), t em [0, 1): polinômio de grau 5 (minimax, Remez),
+    // erro máximo ~1.4e-5 em log2 (~4.3e-5 dB)
+    const float kC1 = 1.44196562f;
+    const float kC2 = -0.709662829f;
+    const float kC3 = 0.417595805f;
+    const float kC4 = -0.19626966f;
+    const float kC5 = 0.0463853689f;
+
+    inline float fastLog2(float x)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        float exponent = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+        uint32_t mantissaBits = (bits & 0x007FFFFFu) | 0x3F800000u;
+        float mantissa;
+        std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+        float t = mantissa - 1.0f;
+        float p = t * (kC1 + t * (kC2 + t * (kC3 + t * (kC4 + t * kC5))));
+        return exponent + p;
+    }
+
+    void powerToDbScalar(const std::complex<float> *spectrum, int count, float referenceDb,
+                         float *dbOut, float &minDb, float &maxDb)
+    {
+        const float *data = reinterpret_cast<const float *>(spectrum);
+        float localMin = minDb;
+        float localMax = maxDb;
+        for (int i = 0; i < count; ++i) {
+            float re = data[2 * i];
+            float im = data[2 * i + 1];
+            float power = std::max(re * re + im * im, SpectrumKernels::MinPower);
+            float db = kDbPerLog2 * fastLog2(power) - referenceDb;
+            dbOut[i] = db;
+            localMin = std::min(localMin, db);
+            localMax = std::max(localMax, db);
+        }
+        minDb = localMin;
+        maxDb = localMax;
+    }
+
+#ifdef SPECTRUMKERNELS_X86
+    __attribute__((target("sse2")))
+    void powerToDbSse2(const std::complex<float> *spectrum, int count, float referenceDb,
+                       float *dbOut, float &minDb, float &maxDb)
+    {
+        const float *data = reinterpret_cast<const float *>(spectrum);
+        const __m128 minPower = _mm_set1_ps(SpectrumKernels::MinPower);
+        const __m128 dbPerLog2 = _mm_set1_ps(kDbPerLog2);
+        const __m128 reference = _mm_set1_ps(referenceDb);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128i mantissaMask = _mm_set1_epi32(0x007FFFFF);
+        const __m128i exponentOne = _mm_set1_epi32(0x3F800000);
+        const __m128i bias = _mm_set1_epi32(127);
+        __m128 vmin = _mm_set1_ps(minDb);
+        __m128 vmax = _mm_set1_ps(maxDb);
+
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            // 4 bins: (r0 i0 r1 i1) (r2 i2 r3 i3) -> reais e imaginários
+            __m128 a = _mm_loadu_ps(data + 2 * i);
+            __m128 b = _mm_loadu_ps(data + 2 * i + 4);
+            __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 power = _mm_max_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)), minPower);
+
+            // log2 = expoente + polinômio(mantissa - 1)
+            __m128i bits = _mm_castps_si128(power);
+            __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+            __m128 t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMask), exponentOne)), one);
+            __m128 p = _mm_add_ps(_mm_set1_ps(kC4), _mm_mul_ps(t, _mm_set1_ps(kC5)));
+            p = _mm_add_ps(_mm_set1_ps(kC3), _mm_mul_ps(t, p));
+            p = _mm_add_ps(_mm_set1_ps(kC2), _mm_mul_ps(t, p));
+            p = _mm_add_ps(_mm_set1_ps(kC1), _mm_mul_ps(t, p));
+            __m128 log2 = _mm_add_ps(exponent, _mm_mul_ps(t, p));
+
+            __m128 db = _mm_sub_ps(_mm_mul_ps(log2, dbPerLog2), reference);
+            _mm_storeu_ps(dbOut + i, db);
+            vmin = _mm_min_ps(vmin, db);
+            vmax = _mm_max_ps(vmax, db);
+        }
+
+        float mins[4];
+        float maxs[4];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+        minDb = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+        maxDb = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+
+        // Bins restantes
+        powerToDbScalar(spectrum + i, count - i, referenceDb, dbOut + i, minDb, maxDb);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void powerToDbAvx2(const std::complex<float> *spectrum, int count, float referenceDb,
+                       float *dbOut, float &minDb, float &maxDb)
+    {
+        const float *data = reinterpret_cast<const float *>(spectrum);
+        const __m256 minPower = _mm256_set1_ps(SpectrumKernels::MinPower);
+        const __m256 dbPerLog2 = _mm256_set1_ps(kDbPerLog2);
+        const __m256 reference = _mm256_set1_ps(referenceDb);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256i mantissaMask = _mm256_set1_epi32(0x007FFFFF);
+        const __m256i exponentOne = _mm256_set1_epi32(0x3F800000);
+        const __m256i bias = _mm256_set1_epi32(127);
+        __m256 vmin = _mm256_set1_ps(minDb);
+        __m256 vmax = _mm256_set1_ps(maxDb);
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            // 8 bins; o shuffle trabalha por metade de 128 bits, o permute
+            // reordena as metades: r0..r7 e i0..i7
+            __m256 a = _mm256_loadu_ps(data + 2 * i);
+            __m256 b = _mm256_loadu_ps(data + 2 * i + 8);
+            __m256 re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(re), _MM_SHUFFLE(3, 1, 2, 0)));
+            im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(im), _MM_SHUFFLE(3, 1, 2, 0)));
+            __m256 power = _mm256_max_ps(_mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im)), minPower);
+
+            __m256i bits = _mm256_castps_si256(power);
+            __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias));
+            __m256 t = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, mantissaMask), exponentOne)), one);
+            __m256 p = _mm256_fmadd_ps(t, _mm256_set1_ps(kC5), _mm256_set1_ps(kC4));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(kC3));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(kC2));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(kC1));
+            __m256 log2 = _mm256_fmadd_ps(t, p, exponent);
+
+            __m256 db = _mm256_fmsub_ps(log2, dbPerLog2, reference);
+            _mm256_storeu_ps(dbOut + i, db);
+            vmin = _mm256_min_ps(vmin, db);
+            vmax = _mm256_max_ps(vmax, db);
+        }
+
+        float mins[8];
+        float maxs[8];
+        _mm256_storeu_ps(mins, vmin);
+        _mm256_storeu_ps(maxs, vmax);
+        minDb = *std::min_element(mins, mins + 8);
+        maxDb = *std::max_element(maxs, maxs + 8);
+
+        // Bins restantes
+        powerToDbScalar(spectrum + i, count - i, referenceDb, dbOut + i, minDb, maxDb);
+    }
+#endif
+
+    using PowerToDbFunction = void (*)(const std::complex<float> *, int, float, float *, float &, float &);
+
+    struct Dispatch {
+        PowerToDbFunction powerToDb;
+        const char *name;
+    };
+
+    // Implementações suportadas pela CPU, da mais rápida para a mais lenta
+    int supportedImplementations(Dispatch *out)
+    {
+        int count = 0;
+#ifdef SPECTRUMKERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            out[count++] = {powerToDbAvx2, "avx2"};
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            out[count++] = {powerToDbSse2, "sse2"};
+        }
+#endif
+        out[count++] = {powerToDbScalar, "scalar"};
+        return count;
+    }
+
+    Dispatch selectImplementation()
+    {
+        Dispatch supported[3];
+        supportedImplementations(supported);
+        return supported[0];
+    }
+
+    Dispatch &dispatch()
+    {
+        static Dispatch selected = selectImplementation();
+        return selected;
+    }
+}
+
+namespace SpectrumKernels {
+
+    void powerToDb(const std::complex<float> *spectrum, int count, float referenceDb,
+                   float *dbOut, float &minDb, float &maxDb)
+    {
+        dispatch().powerToDb(spectrum, count, referenceDb, dbOut, minDb, maxDb);
+    }
+
+    void powerToDbReference(const std::complex<float> *spectrum, int count, float referenceDb,
+                            float *dbOut, float &minDb, float &maxDb)
+    {
+        for (int i = 0; i < count; ++i) {
+            float power = std::max(std::norm(spectrum[i]), MinPower);
+            float db = 10.0f * std::log10(power) - referenceDb;
+            dbOut[i] = db;
+            minDb = std::min(minDb, db);
+            maxDb = std::max(maxDb, db);
+        }
+    }
+
+    const char *implementationName()
+    {
+        return dispatch().name;
+    }
+
+    bool setImplementation(const char *name)
+    {
+        Dispatch supported[3];
+        int count = supportedImplementations(supported);
+        for (int i = 0; i < count; ++i) {
+            if (std::strcmp(supported[i].name, name) == 0) {
+                dispatch() = supported[i];
+                return true;
+            }
+        }
+        return false;
+    }
+}
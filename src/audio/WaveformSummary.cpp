@@ -0,0 +1,161 @@
+#include "audio/WaveformSummary.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Blocos de cada nível; cada um agrupa 16 blocos do nível abaixo
+    const int kBlockSizes[WaveformSummary::NumLevels] = { 256, 4096, 65536 };
+}
+
+WaveformSummary::WaveformSummary()
+    : m_numSamples(0)
+{
+}
+
+int WaveformSummary::blockSize(int level)
+{
+    return kBlockSizes[level];
+}
+
+void WaveformSummary::append(const float *samples, int count)
+{
+    Accumulator &acc = m_accumulators[0];
+    const qint64 blockSamples = kBlockSizes[0];
+
+    int i = 0;
+    while (i < count) {
+        int n = static_cast<int>(std::min<qint64>(count - i, blockSamples - acc.count));
+        float minVal = acc.count > 0 ? acc.min : samples[i];
+        float maxVal = acc.count > 0 ? acc.max : samples[i];
+        double sumSquares = 0.0;
+        for (int j = i; j < i + n; ++j) {
+            float sample = samples[j];
+            minVal = std::min(minVal, sample);
+            maxVal = std::max(maxVal, sample);
+            sumSquares += static_cast<double>(sample) * sample;
+        }
+        acc.min = minVal;
+        acc.max = maxVal;
+        acc.sumSquares += sumSquares;
+        acc.count += n;
+        i += n;
+
+        if (acc.count == blockSamples) {
+            closeBlock(0);
+        }
+    }
+    m_numSamples += count;
+}
+
+void WaveformSummary::finish()
+{
+    // Do nível mais fino ao mais grosso: o bloco parcial de um nível entra
+    // no bloco parcial do nível acima antes de este ser fechado
+    for (int level = 0; level < NumLevels; ++level) {
+        if (m_accumulators[level].count > 0) {
+            closeBlock(level);
+        }
+    }
+}
+
+void WaveformSummary::closeBlock(int level)
+{
+    Accumulator &acc = m_accumulators[level];
+    Block block;
+    block.min = acc.min;
+    block.max = acc.max;
+    block.rms = static_cast<float>(std::sqrt(acc.sumSquares / acc.count));
+    m_levels[level].append(block);
+
+    qint64 count = acc.count;
+    acc = Accumulator();
+
+    if (level + 1 < NumLevels) {
+        addToLevel(level + 1, block, count);
+    }
+}
+
+void WaveformSummary::addToLevel(int level, const Block &block, qint64 count)
+{
+    Accumulator &acc = m_accumulators[level];
+    if (acc.count == 0) {
+        acc.min = block.min;
+        acc.max = block.max;
+    } else {
+        acc.min = std::min(acc.min, block.min);
+        acc.max = std::max(acc.max, block.max);
+    }
+    acc.sumSquares += static_cast<double>(block.rms) * block.rms * count;
+    acc.count += count;
+
+    if (acc.count == kBlockSizes[level]) {
+        closeBlock(level);
+    }
+}
+
+int WaveformSummary::levelFor(double samplesPerPixel)
+{
+    int result = -1;
+    for (int level = 0; level < NumLevels; ++level) {
+        if (kBlockSizes[level] <= samplesPerPixel) {
+            result = level;
+        }
+    }
+    return result;
+}
+
+WaveformSummary::Block WaveformSummary::range(int level, qint64 startSample, qint64 endSample) const
+{
+    const QVector<Block> &blocks = m_levels[level];
+    Block result;
+    if (blocks.isEmpty()) {
+        return result;
+    }
+
+    const qint64 size = kBlockSizes[level];
+    const qint64 numBlocks = blocks.size();
+    int first = static_cast<int>(std::max<qint64>(0, std::min(numBlocks - 1, startSample / size)));
+    int last = static_cast<int>(std::max<qint64>(first + 1, std::min(numBlocks, (endSample + size - 1) / size)));
+
+    // RMS ponderado pelas amostras de cada bloco (o último pode ser parcial)
+    result = blocks[first];
+    result.rms = 0.0f;
+    double sumSquares = 0.0;
+    qint64 count = 0;
+    for (int i = first; i < last; ++i) {
+        const Block &block = blocks[i];
+        qint64 blockCount = std::min(size, m_numSamples - i * size);
+        result.min = std::min(result.min, block.min);
+        result.max = std::max(result.max, block.max);
+        sumSquares += static_cast<double>(block.rms) * block.rms * blockCount;
+        count += blockCount;
+    }
+    if (count > 0) {
+        result.rms = static_cast<float>(std::sqrt(sumSquares / count));
+    }
+    return result;
+}
+
+QVector<WaveformSummary::Block> WaveformSummary::overview(int numBins) const
+{
+    QVector<Block> result;
+    if (m_levels[0].isEmpty() || numBins <= 0) {
+        return result;
+    }
+    if (m_levels[0].size() <= numBins) {
+        return m_levels[0];
+    }
+
+    int level = 0;
+    while (level + 1 < NumLevels && m_levels[level + 1].size() >= numBins) {
+        ++level;
+    }
+
+    result.reserve(numBins);
+    for (int bin = 0; bin < numBins; ++bin) {
+        qint64 start = m_numSamples * bin / numBins;
+        qint64 end = m_numSamples * (bin + 1) / numBins;
+        result.append(range(level, start, end));
+    }
+    return result;
+}
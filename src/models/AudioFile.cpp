@@ -1,9 +1,21 @@
 #include "models/AudioFile.h"
+#include "audio/Decimator.h"
+#include "audio/SpectrogramCache.h"
+#include "audio/SpectrogramDiskCache.h"
 #include <QFileInfo>
 #include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+    // Identificadores dos arquivos (chave dos caches de espectrograma)
+    std::atomic<quint64> s_nextId(1);
+}
 
 AudioFile::AudioFile(QObject *parent)
     : QObject(parent)
+    , m_id(s_nextId++)
     , m_sampleRate(0)
     , m_numChannels(0)
     , m_numSamples(0)
@@ -13,11 +25,13 @@ AudioFile::AudioFile(QObject *parent)
     , m_loaded(false)
     , m_hasPitchData(false)
     , m_hasIntensityData(false)
+    , m_contentKeySize(-1)
 {
 }
 
 AudioFile::AudioFile(const QString &filePath, QObject *parent)
     : QObject(parent)
+    , m_id(s_nextId++)
     , m_filePath(filePath)
     , m_sampleRate(0)
     , m_numChannels(0)
@@ -28,6 +42,7 @@ AudioFile::AudioFile(const QString &filePath, QObject *parent)
     , m_loaded(false)
     , m_hasPitchData(false)
     , m_hasIntensityData(false)
+    , m_contentKeySize(-1)
 {
     QFileInfo fileInfo(filePath);
     m_fileSize = fileInfo.size();
@@ -36,6 +51,7 @@ AudioFile::AudioFile(const QString &filePath, QObject *parent)
 AudioFile::~AudioFile()
 {
     unload();
+    SpectrogramCache::instance().removeFile(m_id);
 }
 
 QString AudioFile::getFileName() const
@@ -78,16 +94,61 @@ QVector<float> AudioFile::getMixedSamples() const
     return mixed;
 }
 
+QVector<float> AudioFile::getDecimatedSamples(int factor, int channel) const
+{
+    if (factor <= 1) {
+        return getSamples(channel);
+    }
+    
+    // O mutex serializa o cálculo: chamadas simultâneas esperam o primeiro
+    // resultado em vez de decimar o mesmo sinal novamente
+    QMutexLocker locker(&m_decimatedMutex);
+    quint64 key = (static_cast<quint64>(channel) << 32) | static_cast<quint32>(factor);
+    auto it = m_decimatedSamples.constFind(key);
+    if (it != m_decimatedSamples.constEnd()) {
+        return it.value();
+    }
+    
+    QVector<float> decimated = Decimator::decimate(getSamples(channel), factor);
+    m_decimatedSamples.insert(key, decimated);
+    return decimated;
+}
+
+QString AudioFile::getContentKey() const
+{
+    QMutexLocker locker(&m_contentKeyMutex);
+    QFileInfo info(m_filePath);
+    if (!m_contentKey.isEmpty() && info.size() == m_contentKeySize
+        && info.lastModified() == m_contentKeyModified) {
+        return m_contentKey;
+    }
+    
+    // Vazia enquanto é calculada em segundo plano: não guardar
+    m_contentKey = SpectrogramDiskCache::instance().fingerprint(m_filePath);
+    m_contentKeySize = info.size();
+    m_contentKeyModified = info.lastModified();
+    return m_contentKey;
+}
+
 void AudioFile::setNumChannels(int numChannels)
 {
     m_numChannels = numChannels;
     m_channelSamples.resize(numChannels);
+    m_waveformSummaries.resize(numChannels);
 }
 
 void AudioFile::setSamples(int channel, const QVector<float> &samples)
 {
     if (channel >= 0 && channel < m_numChannels) {
         m_channelSamples[channel] = samples;
+        m_waveformSummaries[channel].reset();
+        if (channel < 2) {
+            m_midSideSummaries[0].reset();
+            m_midSideSummaries[1].reset();
+        }
+        
+        QMutexLocker locker(&m_decimatedMutex);
+        m_decimatedSamples.clear();
         if (m_numSamples == 0) {
             m_numSamples = samples.size();
             if (m_sampleRate > 0) {
@@ -97,6 +158,33 @@ void AudioFile::setSamples(int channel, const QVector<float> &samples)
     }
 }
 
+void AudioFile::setWaveformSummary(int channel, std::shared_ptr<const WaveformSummary> summary)
+{
+    if (channel >= 0 && channel < m_waveformSummaries.size()) {
+        m_waveformSummaries[channel] = std::move(summary);
+    }
+}
+
+void AudioFile::setMidSideSummaries(std::shared_ptr<const WaveformSummary> mid,
+                                    std::shared_ptr<const WaveformSummary> side)
+{
+    m_midSideSummaries[0] = std::move(mid);
+    m_midSideSummaries[1] = std::move(side);
+}
+
+std::shared_ptr<const WaveformSummary> AudioFile::getMidSideSummary(bool side) const
+{
+    return m_midSideSummaries[side ? 1 : 0];
+}
+
+std::shared_ptr<const WaveformSummary> AudioFile::getWaveformSummary(int channel) const
+{
+    if (channel < 0 || channel >= m_waveformSummaries.size()) {
+        return nullptr;
+    }
+    return m_waveformSummaries[channel];
+}
+
 void AudioFile::setPitchData(const QVector<float> &pitchData)
 {
     m_pitchData = pitchData;
@@ -127,6 +215,13 @@ void AudioFile::unload()
 {
     if (m_loaded) {
         m_channelSamples.clear();
+        m_waveformSummaries.clear();
+        m_midSideSummaries[0].reset();
+        m_midSideSummaries[1].reset();
+        {
+            QMutexLocker locker(&m_decimatedMutex);
+            m_decimatedSamples.clear();
+        }
         m_pitchData.clear();
         m_intensityData.clear();
         m_hasPitchData = false;
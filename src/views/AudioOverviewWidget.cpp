@@ -0,0 +1,387 @@
+#include "views/AudioOverviewWidget.h"
+#include "audio/FrequencyScale.h"
+#include "models/AudioFile.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QSettings>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+    // Intervalos do resumo da forma de onda (independe da duração)
+    const int kSummaryBins = 2048;
+
+    // Colunas da miniatura do espectrograma (uma FFT cada)
+    const int kThumbnailColumns = 512;
+
+    // Mesma margem esquerda da forma de onda e do espectrograma
+    const int kLeftMargin = 50;
+}
+
+AudioOverviewWidget::AudioOverviewWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_viewStartTime(0.0)
+    , m_viewDuration(0.0)
+    , m_pixmapValid(false)
+    , m_showSpectrogram(false)
+    , m_dynamicRange(90.0)
+    , m_thumbnailGeneration(0)
+    , m_thumbnailPending(false)
+    , m_runningGeneration(0)
+    , m_isDragging(false)
+    , m_dragOffset(0.0)
+{
+    setFixedHeight(48);
+    setCursor(Qt::PointingHandCursor);
+
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    m_showSpectrogram = settings.value("overview/showSpectrogram", false).toBool();
+
+    connect(&m_thumbnailWatcher, &QFutureWatcher<SpectrogramTile>::finished,
+            this, &AudioOverviewWidget::onThumbnailFinished);
+}
+
+AudioOverviewWidget::~AudioOverviewWidget()
+{
+    // Interromper a miniatura em andamento
+    ++m_thumbnailGeneration;
+    m_thumbnailWatcher.waitForFinished();
+}
+
+void AudioOverviewWidget::setAudioFile(std::shared_ptr<AudioFile> audioFile)
+{
+    if (m_audioFile) {
+        disconnect(m_audioFile.get(), nullptr, this, nullptr);
+    }
+    m_audioFile = audioFile;
+
+    // O resumo e a miniatura dependem das amostras
+    if (m_audioFile) {
+        connect(m_audioFile.get(), &AudioFile::loaded, this, &AudioOverviewWidget::invalidateOverview);
+        connect(m_audioFile.get(), &AudioFile::unloaded, this, &AudioOverviewWidget::invalidateOverview);
+    }
+
+    m_viewStartTime = 0.0;
+    m_viewDuration = m_audioFile ? m_audioFile->getDuration() : 0.0;
+    m_thumbnailTile = SpectrogramTile();
+    m_thumbnail = QImage();
+    invalidateOverview();
+}
+
+void AudioOverviewWidget::setVisibleTimeRange(double startTime, double duration)
+{
+    // Apenas o retângulo anterior e o novo são repintados
+    QRect previous = viewportRect(m_viewStartTime, m_viewDuration);
+    m_viewStartTime = startTime;
+    m_viewDuration = duration;
+    QRect current = viewportRect(m_viewStartTime, m_viewDuration);
+    if (current != previous) {
+        update(previous.united(current));
+    }
+}
+
+void AudioOverviewWidget::setSpectrogramSettings(const SpectrogramCalculator::Parameters &params,
+                                                 double dynamicRange, const QString &colorMap,
+                                                 const QString &frequencyScale)
+{
+    SpectrogramCalculator::Parameters primary = params.analysis(0);
+    bool paramsChanged = primary != m_params;
+    bool styleChanged = dynamicRange != m_dynamicRange || colorMap != m_colorMap ||
+                        frequencyScale != m_frequencyScale;
+    m_params = primary;
+    m_dynamicRange = dynamicRange;
+    m_colorMap = colorMap;
+    m_frequencyScale = frequencyScale;
+
+    if (paramsChanged) {
+        requestThumbnail();
+    } else if (styleChanged) {
+        // Cores e escala: apenas a conversão da miniatura, sem FFT
+        updateThumbnailImage();
+    }
+}
+
+void AudioOverviewWidget::setShowSpectrogram(bool show)
+{
+    if (show == m_showSpectrogram) {
+        return;
+    }
+    m_showSpectrogram = show;
+
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    settings.setValue("overview/showSpectrogram", show);
+
+    if (show && m_thumbnailTile.isNull()) {
+        requestThumbnail();
+    }
+    m_pixmapValid = false;
+    update();
+}
+
+void AudioOverviewWidget::invalidateOverview()
+{
+    rebuildSummary();
+    requestThumbnail();
+    m_pixmapValid = false;
+    update();
+}
+
+void AudioOverviewWidget::rebuildSummary()
+{
+    // Canais combinados: menor mínimo e maior máximo de cada intervalo
+    m_summary.clear();
+    if (!m_audioFile) {
+        return;
+    }
+    for (int ch = 0; ch < m_audioFile->getNumChannels(); ++ch) {
+        std::shared_ptr<const WaveformSummary> summary = m_audioFile->getWaveformSummary(ch);
+        if (!summary || summary->isEmpty()) {
+            continue;
+        }
+        QVector<WaveformSummary::Block> bins = summary->overview(kSummaryBins);
+        if (m_summary.isEmpty()) {
+            m_summary = bins;
+            continue;
+        }
+        int count = std::min(m_summary.size(), bins.size());
+        for (int i = 0; i < count; ++i) {
+            m_summary[i].min = std::min(m_summary[i].min, bins[i].min);
+            m_summary[i].max = std::max(m_summary[i].max, bins[i].max);
+            m_summary[i].rms = std::max(m_summary[i].rms, bins[i].rms);
+        }
+    }
+}
+
+void AudioOverviewWidget::requestThumbnail()
+{
+    if (!m_showSpectrogram || !m_audioFile || m_audioFile->getDuration() <= 0.0) {
+        return;
+    }
+
+    // A miniatura em andamento fica obsoleta e para na próxima coluna; a
+    // nova começa quando ela terminar
+    ++m_thumbnailGeneration;
+    if (m_thumbnailWatcher.isRunning()) {
+        m_thumbnailPending = true;
+        return;
+    }
+    startThumbnail();
+}
+
+void AudioOverviewWidget::startThumbnail()
+{
+    m_thumbnailPending = false;
+    if (!m_audioFile) {
+        return;
+    }
+
+    const quint64 generation = m_thumbnailGeneration.load();
+    const std::shared_ptr<AudioFile> audioFile = m_audioFile;
+    const SpectrogramCalculator::Parameters params = m_params;
+    m_runningGeneration = generation;
+    m_thumbnailParams = params;
+
+    m_thumbnailWatcher.setFuture(QtConcurrent::run([this, audioFile, params, generation]() {
+        return SpectrogramCalculator::computePreview(*audioFile, params, 0.0, audioFile->getDuration(),
+                                                     kThumbnailColumns, [this, generation]() {
+            return m_thumbnailGeneration.load() != generation;
+        });
+    }));
+}
+
+void AudioOverviewWidget::onThumbnailFinished()
+{
+    SpectrogramTile tile = m_thumbnailWatcher.result();
+    if (!tile.isNull() && m_runningGeneration == m_thumbnailGeneration.load()) {
+        m_thumbnailTile = tile;
+        updateThumbnailImage();
+    }
+
+    if (m_thumbnailPending) {
+        startThumbnail();
+    }
+}
+
+void AudioOverviewWidget::updateThumbnailImage()
+{
+    if (m_thumbnailTile.isNull() || !m_audioFile) {
+        return;
+    }
+
+    // Mesma conversão da visualização: escala de frequência, níveis de
+    // 8 bits e paleta da faixa dinâmica
+    SpectrogramCalculator::Geometry geometry = SpectrogramCalculator::computeGeometry(
+        m_thumbnailParams, m_audioFile->getSampleRate(), m_audioFile->getNumSamples());
+    if (!geometry.isValid()) {
+        return;
+    }
+    double binFrequency = static_cast<double>(geometry.sampleRate) / geometry.fftSize;
+    FrequencyScale scale(FrequencyScale::typeFromName(m_frequencyScale),
+                         geometry.minBin * binFrequency, geometry.maxBin * binFrequency);
+
+    FrequencyRemap remap;
+    if (scale.type() != FrequencyScale::Linear) {
+        remap = FrequencyRemap::build(scale, binFrequency, geometry.minBin, geometry.numBins(),
+                                      std::max(1, plotArea().height()));
+    }
+
+    m_thumbnail = SpectrogramCalculator::quantize(m_thumbnailTile, remap);
+    m_thumbnail.setColorTable(SpectrogramCalculator::palette(
+        m_dynamicRange, SpectrogramCalculator::colorMapFromName(m_colorMap)));
+    m_pixmapValid = false;
+    update();
+}
+
+QRect AudioOverviewWidget::plotArea() const
+{
+    return QRect(kLeftMargin, 2, std::max(1, width() - kLeftMargin), std::max(1, height() - 4));
+}
+
+QRect AudioOverviewWidget::viewportRect(double startTime, double duration) const
+{
+    QRect area = plotArea();
+    double totalDuration = m_audioFile ? m_audioFile->getDuration() : 0.0;
+    if (totalDuration <= 0.0 || duration <= 0.0) {
+        return QRect();
+    }
+    int left = area.left() + static_cast<int>(startTime / totalDuration * area.width());
+    int right = area.left() + static_cast<int>((startTime + duration) / totalDuration * area.width());
+    // Ao menos 3 px, para continuar visível com zoom alto; mais a borda
+    return QRect(left - 1, 0, std::max(3, right - left) + 2, height());
+}
+
+double AudioOverviewWidget::pixelToTime(int x) const
+{
+    QRect area = plotArea();
+    double totalDuration = m_audioFile ? m_audioFile->getDuration() : 0.0;
+    return static_cast<double>(x - area.left()) / area.width() * totalDuration;
+}
+
+void AudioOverviewWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+
+    if (!m_audioFile) {
+        painter.fillRect(rect(), Qt::white);
+        return;
+    }
+
+    qreal ratio = devicePixelRatioF();
+    QSize pixmapSize = size() * ratio;
+    if (!m_pixmapValid || m_pixmap.size() != pixmapSize) {
+        m_pixmap = QPixmap(pixmapSize);
+        m_pixmap.setDevicePixelRatio(ratio);
+        m_pixmap.fill(Qt::white);
+        QPainter pixmapPainter(&m_pixmap);
+        drawOverview(pixmapPainter);
+        m_pixmapValid = true;
+    }
+
+    QRect dirty = event->rect();
+    painter.drawPixmap(dirty, m_pixmap,
+                       QRectF(dirty.topLeft() * ratio, dirty.size() * ratio).toRect());
+
+    // Trecho visível
+    QRect viewport = viewportRect(m_viewStartTime, m_viewDuration);
+    if (!viewport.isNull()) {
+        QRect box = viewport.adjusted(1, 0, -1, -1);
+        painter.fillRect(box, QColor(100, 150, 255, 60));
+        painter.setPen(QPen(QColor(0, 100, 200), 1));
+        painter.drawRect(box);
+    }
+}
+
+void AudioOverviewWidget::drawOverview(QPainter &painter)
+{
+    QRect area = plotArea();
+
+    // Borda
+    painter.setPen(QPen(QColor(200, 200, 200), 1));
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    bool thumbnail = m_showSpectrogram && !m_thumbnail.isNull();
+    if (thumbnail) {
+        painter.drawImage(area, m_thumbnail);
+    }
+
+    if (m_summary.isEmpty()) {
+        return;
+    }
+
+    // Um intervalo do resumo ou mais por pixel: O(max(largura, intervalos))
+    int centerY = area.center().y();
+    int halfHeight = area.height() / 2;
+    int numBins = m_summary.size();
+    QVector<QLine> lines;
+    lines.reserve(area.width());
+    for (int x = 0; x < area.width(); ++x) {
+        int first = static_cast<int>(static_cast<qint64>(x) * numBins / area.width());
+        int last = std::max(first + 1, static_cast<int>(static_cast<qint64>(x + 1) * numBins / area.width()));
+        last = std::min(last, numBins);
+        float minVal = 0.0f;
+        float maxVal = 0.0f;
+        for (int i = first; i < last; ++i) {
+            minVal = std::min(minVal, m_summary[i].min);
+            maxVal = std::max(maxVal, m_summary[i].max);
+        }
+        lines.append(QLine(area.left() + x, centerY - static_cast<int>(maxVal * halfHeight),
+                           area.left() + x, centerY - static_cast<int>(minVal * halfHeight)));
+    }
+
+    // Sobre a miniatura, a forma de onda fica translúcida
+    painter.setPen(QPen(thumbnail ? QColor(255, 255, 255, 120) : QColor(0, 100, 200), 1));
+    painter.drawLines(lines);
+}
+
+void AudioOverviewWidget::moveViewportTo(double startTime)
+{
+    double totalDuration = m_audioFile->getDuration();
+    double duration = std::min(m_viewDuration, totalDuration);
+    startTime = std::max(0.0, std::min(startTime, totalDuration - duration));
+    if (startTime == m_viewStartTime) {
+        return;
+    }
+    setVisibleTimeRange(startTime, duration);
+    emit visibleTimeRangeChanged(m_viewStartTime, m_viewDuration);
+}
+
+void AudioOverviewWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (!m_audioFile || event->button() != Qt::LeftButton) {
+        return;
+    }
+
+    // Clique fora do retângulo: centralizar o trecho no ponto clicado
+    double clickTime = pixelToTime(event->pos().x());
+    if (!viewportRect(m_viewStartTime, m_viewDuration).contains(event->pos())) {
+        moveViewportTo(clickTime - m_viewDuration / 2.0);
+    }
+    m_isDragging = true;
+    m_dragOffset = clickTime - m_viewStartTime;
+    setCursor(Qt::ClosedHandCursor);
+}
+
+void AudioOverviewWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_isDragging && m_audioFile) {
+        moveViewportTo(pixelToTime(event->pos().x()) - m_dragOffset);
+    }
+}
+
+void AudioOverviewWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        m_isDragging = false;
+        setCursor(Qt::PointingHandCursor);
+    }
+}
+
+void AudioOverviewWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    // A escala não linear da miniatura depende da altura
+    updateThumbnailImage();
+    m_pixmapValid = false;
+}
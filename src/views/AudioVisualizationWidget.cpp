@@ -1,5 +1,8 @@
 #include "views/AudioVisualizationWidget.h"
 #include "models/AudioFile.h"
+#include "audio/WaveformSummary.h"
+#include "audio/SincInterpolator.h"
+#include "audio/AudioStreamReader.h"
 #include "utils/Logger.h"
 #include <QPainter>
 #include <QPaintEvent>
@@ -7,9 +10,21 @@
 #include <QWheelEvent>
 #include <QTimer>
 #include <QKeyEvent>
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QSettings>
 #include <cmath>
 #include <cstdlib>
 
+namespace {
+    // Tabela polifásica da reconstrução em nível de amostra
+    const int kSincTapsPerSide = 8;
+    const int kSincPhases = 256;
+    
+    // Distância mínima (pixels) entre amostras para marcar suas posições
+    const double kMinSampleMarkerSpacing = 4.0;
+}
+
 AudioVisualizationWidget::AudioVisualizationWidget(QWidget *parent)
     : QWidget(parent)
     , m_viewStartTime(0.0)
@@ -17,25 +32,31 @@ AudioVisualizationWidget::AudioVisualizationWidget(QWidget *parent)
     , m_zoomLevel(1.0)
     , m_spectrogramZoomThreshold(5.0)
     , m_showSpectrogram(false)
+    , m_showMidSide(false)
     , m_hasSelection(false)
     , m_selectionStart(0.0)
     , m_selectionEnd(0.0)
     , m_playbackPosition(0.0)
     , m_isPlaying(false)
+    , m_playbackCursorX(-1)
     , m_isDragging(false)
     , m_isSelecting(false)
     , m_mouseInWidget(false)
+    , m_pixmapValid(false)
 {
     setMinimumHeight(200);
     setFocusPolicy(Qt::StrongFocus); // Permitir receber eventos de teclado
     setMouseTracking(true); // Rastrear movimento do mouse
     
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    m_showMidSide = settings.value("waveform/showMidSide", false).toBool();
+    
     // Timer para atualizar visualização durante reprodução
     m_updateTimer = new QTimer(this);
     m_updateTimer->setInterval(16); // ~60 FPS para melhor sincronização
     connect(m_updateTimer, &QTimer::timeout, this, [this]() {
         if (m_isPlaying) {
-            update();
+            updatePlaybackCursor();
         }
     });
 }
@@ -46,8 +67,17 @@ AudioVisualizationWidget::~AudioVisualizationWidget()
 
 void AudioVisualizationWidget::setAudioFile(std::shared_ptr<AudioFile> audioFile)
 {
+    if (m_audioFile) {
+        disconnect(m_audioFile.get(), nullptr, this, nullptr);
+    }
     m_audioFile = audioFile;
     
+    // Amostras carregadas ou descarregadas: refazer a imagem da forma de onda
+    if (m_audioFile) {
+        connect(m_audioFile.get(), &AudioFile::loaded, this, &AudioVisualizationWidget::invalidateWaveform);
+        connect(m_audioFile.get(), &AudioFile::unloaded, this, &AudioVisualizationWidget::invalidateWaveform);
+    }
+    
     // Limpar estado anterior
     m_hasSelection = false;
     m_selectionStart = 0.0;
@@ -61,6 +91,9 @@ void AudioVisualizationWidget::setAudioFile(std::shared_ptr<AudioFile> audioFile
         LOG_AUDIO("Timer de atualização PARADO ao trocar arquivo");
     }
     
+    // Novo arquivo: todos os canais visíveis
+    m_channelVisible.fill(true, m_audioFile ? m_audioFile->getNumChannels() : 0);
+    
     if (m_audioFile) {
         // Ajustar visualização para mostrar todo o áudio
         m_viewStartTime = 0.0;
@@ -71,7 +104,7 @@ void AudioVisualizationWidget::setAudioFile(std::shared_ptr<AudioFile> audioFile
         LOG_AUDIO("Arquivo removido da visualização");
     }
     
-    update();
+    invalidateWaveform();
 }
 
 void AudioVisualizationWidget::setShowSpectrogram(bool show)
@@ -97,14 +130,15 @@ void AudioVisualizationWidget::zoomFit()
         m_viewDuration = m_audioFile->getDuration();
         m_viewStartTime = 0.0;
         m_zoomLevel = 1.0;
-        update();
+        invalidateWaveform();
+        emit visibleTimeRangeChanged(m_viewStartTime, m_viewStartTime + m_viewDuration);
     }
 }
 
 void AudioVisualizationWidget::scrollToTime(double timeSeconds)
 {
     m_viewStartTime = timeSeconds;
-    update();
+    invalidateWaveform();
 }
 
 void AudioVisualizationWidget::getVisibleTimeRange(double &startTime, double &endTime) const
@@ -117,7 +151,7 @@ void AudioVisualizationWidget::setVisibleTimeRange(double startTime, double dura
 {
     m_viewStartTime = startTime;
     m_viewDuration = duration;
-    update();
+    invalidateWaveform();
 }
 
 void AudioVisualizationWidget::setTimeSelection(double startTime, double endTime)
@@ -126,14 +160,41 @@ void AudioVisualizationWidget::setTimeSelection(double startTime, double endTime
     m_selectionStart = startTime;
     m_selectionEnd = endTime;
     emit timeSelectionChanged(startTime, endTime);
-    update();
+    invalidateWaveform();
 }
 
 void AudioVisualizationWidget::clearTimeSelection()
 {
     m_hasSelection = false;
     emit timeSelectionCleared();
-    update();
+    invalidateWaveform();
+}
+
+void AudioVisualizationWidget::setChannelVisible(int channel, bool visible)
+{
+    if (channel < 0 || channel >= m_channelVisible.size() || m_channelVisible[channel] == visible) {
+        return;
+    }
+    m_channelVisible[channel] = visible;
+    invalidateWaveform();
+}
+
+bool AudioVisualizationWidget::isChannelVisible(int channel) const
+{
+    return channel >= 0 && channel < m_channelVisible.size() && m_channelVisible[channel];
+}
+
+void AudioVisualizationWidget::setMidSideVisible(bool visible)
+{
+    if (visible == m_showMidSide) {
+        return;
+    }
+    m_showMidSide = visible;
+    
+    QSettings settings("AudioAnnotator", "AudioAnnotator");
+    settings.setValue("waveform/showMidSide", visible);
+    
+    invalidateWaveform();
 }
 
 bool AudioVisualizationWidget::getTimeSelection(double &startTime, double &endTime) const
@@ -151,14 +212,14 @@ void AudioVisualizationWidget::paintEvent(QPaintEvent *event)
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
     
-    // Fundo branco
-    painter.fillRect(rect(), Qt::white);
-    
-    // Desenhar borda
-    painter.setPen(QPen(QColor(200, 200, 200), 1));
-    painter.drawRect(rect().adjusted(0, 0, -1, -1));
-    
     if (!m_audioFile) {
+        // Fundo branco
+        painter.fillRect(rect(), Qt::white);
+        
+        // Desenhar borda
+        painter.setPen(QPen(QColor(200, 200, 200), 1));
+        painter.drawRect(rect().adjusted(0, 0, -1, -1));
+        
         // Placeholder quando não há áudio
         painter.setPen(QColor(150, 150, 150));
         QFont font = painter.font();
@@ -179,6 +240,41 @@ void AudioVisualizationWidget::paintEvent(QPaintEvent *event)
         return;
     }
     
+    // Cabeçalho, eixos, forma de onda e seleção ficam numa imagem do tamanho
+    // do widget, refeita apenas quando a janela, o tamanho, a seleção ou os
+    // dados mudam; cursores e a linha de informação da janela (que mostra o
+    // tempo sob o mouse) são desenhados por cima, só nas áreas alteradas
+    qreal ratio = devicePixelRatioF();
+    QSize pixmapSize = size() * ratio;
+    if (!m_pixmapValid || m_pixmap.size() != pixmapSize) {
+        m_pixmap = QPixmap(pixmapSize);
+        m_pixmap.setDevicePixelRatio(ratio);
+        m_pixmap.fill(Qt::white);
+        QPainter pixmapPainter(&m_pixmap);
+        pixmapPainter.setRenderHint(QPainter::Antialiasing);
+        drawStaticLayers(pixmapPainter);
+        m_pixmapValid = true;
+    }
+    
+    QRect dirty = event->rect();
+    painter.drawPixmap(dirty, m_pixmap,
+                       QRectF(dirty.topLeft() * ratio, dirty.size() * ratio).toRect());
+    
+    if (dirty.intersects(windowInfoRect())) {
+        drawWindowInfo(painter);
+    }
+    drawPlaybackCursor(painter);
+    if (m_mouseInWidget) {
+        drawMouseCursor(painter);
+    }
+}
+
+void AudioVisualizationWidget::drawStaticLayers(QPainter &painter)
+{
+    // Desenhar borda
+    painter.setPen(QPen(QColor(200, 200, 200), 1));
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+    
     // Desenhar informações do arquivo
     painter.setPen(Qt::black);
     QFont font = painter.font();
@@ -193,7 +289,19 @@ void AudioVisualizationWidget::paintEvent(QPaintEvent *event)
                    .arg(m_audioFile->getDuration(), 0, 'f', 2);
     painter.drawText(10, 20, info);
     
+    drawAmplitudeAxis(painter);
+    drawWaveform(painter);
+    drawTimeLabels(painter);
+    if (m_hasSelection) {
+        drawSelection(painter);
+    }
+}
+
+void AudioVisualizationWidget::drawWindowInfo(QPainter &painter)
+{
     // Desenhar informações da janela visível e cursor
+    painter.setPen(Qt::black);
+    QFont font = painter.font();
     font.setPointSize(9);
     font.setBold(false);
     painter.setFont(font);
@@ -213,44 +321,124 @@ void AudioVisualizationWidget::paintEvent(QPaintEvent *event)
                             .arg(m_viewDuration, 0, 'f', 3);
     }
     painter.drawText(width() - 500, 20, windowInfo);
+}
+
+QRect AudioVisualizationWidget::windowInfoRect() const
+{
+    // Linha de texto com base em y = 20, acima da área da forma de onda
+    return QRect(width() - 500, 0, 500, 30);
+}
+
+void AudioVisualizationWidget::invalidateWaveform()
+{
+    // O widget inteiro é repintado: o cursor sai na posição atual
+    m_pixmapValid = false;
+    m_playbackCursorX = playbackCursorX();
+    update();
+}
+
+float AudioVisualizationWidget::WaveformLane::sample(int i) const
+{
+    if (!second) {
+        return (*first)[i - offset];
+    }
+    return 0.5f * ((*first)[i - offset] + sideSign * (*second)[i - offset]);
+}
+
+QVector<AudioVisualizationWidget::WaveformLane> AudioVisualizationWidget::visibleLanes() const
+{
+    QVector<WaveformLane> lanes;
+    if (!m_audioFile) {
+        return lanes;
+    }
     
-    drawAmplitudeAxis(painter);
-    drawWaveform(painter);
-    drawTimeLabels(painter);
-    if (m_hasSelection) {
-        drawSelection(painter);
+    int numChannels = m_audioFile->getNumChannels();
+    for (int ch = 0; ch < numChannels; ++ch) {
+        if (ch < m_channelVisible.size() && !m_channelVisible[ch]) {
+            continue;
+        }
+        WaveformLane lane;
+        lane.name = QString("Canal %1").arg(ch + 1);
+        lane.firstChannel = ch;
+        lane.first = &m_audioFile->getSamples(ch);
+        lane.numSamples = m_audioFile->getNumSamples();
+        lane.summary = m_audioFile->getWaveformSummary(ch);
+        lanes.append(lane);
     }
-    if (m_isPlaying) {
-        drawPlaybackCursor(painter);
+    
+    // Mid/side dos dois primeiros canais
+    if (m_showMidSide && numChannels >= 2) {
+        for (int side = 0; side < 2; ++side) {
+            WaveformLane lane;
+            lane.name = side ? "Side" : "Mid";
+            lane.firstChannel = 0;
+            lane.secondChannel = 1;
+            lane.first = &m_audioFile->getSamples(0);
+            lane.second = &m_audioFile->getSamples(1);
+            lane.numSamples = m_audioFile->getNumSamples();
+            lane.sideSign = side ? -1.0f : 1.0f;
+            lane.summary = m_audioFile->getMidSideSummary(side);
+            lanes.append(lane);
+        }
     }
-    if (m_mouseInWidget) {
-        drawMouseCursor(painter);
+    return lanes;
+}
+
+bool AudioVisualizationWidget::readStreamWindow(int channel, int start, int count,
+                                                QVector<float> &samples) const
+{
+    samples.resize(count);
+    AudioStreamReader reader(m_audioFile->getFilePath(), channel, 1, count);
+    if (!reader.read(start, count, samples.data())) {
+        LOG_AUDIO(QString("Falha ao ler a forma de onda do arquivo: %1").arg(reader.getLastError()));
+        samples.clear();
+        return false;
     }
+    return true;
 }
 
-void AudioVisualizationWidget::drawWaveform(QPainter &painter)
+QVector<QRect> AudioVisualizationWidget::laneAreas(int numLanes) const
 {
-    if (!m_audioFile) return;
+    // Faixas empilhadas entre o cabeçalho e os rótulos de tempo
+    const int leftMargin = 50;
+    const int topMargin = 35;
+    const int bottomMargin = 25;
+    const int spacing = 6;
     
-    int leftMargin = 50;  // Mesma largura da escala do espectrograma
-    int topMargin = 35;
-    int bottomMargin = 25;
+    QVector<QRect> areas;
+    if (numLanes <= 0) {
+        return areas;
+    }
     int drawHeight = height() - topMargin - bottomMargin;
-    int centerY = topMargin + drawHeight / 2;
-    int waveHeight = drawHeight;
-    
-    // Desenhar linha central
-    painter.setPen(QPen(QColor(220, 220, 220), 1));
-    painter.drawLine(leftMargin, centerY, width(), centerY);
+    int laneHeight = qMax(1, (drawHeight - spacing * (numLanes - 1)) / numLanes);
+    for (int i = 0; i < numLanes; ++i) {
+        areas.append(QRect(leftMargin, topMargin + i * (laneHeight + spacing),
+                           width() - leftMargin, laneHeight));
+    }
+    return areas;
+}
+
+void AudioVisualizationWidget::drawWaveform(QPainter &painter)
+{
+    if (!m_audioFile) return;
     
-    // Obter amostras do canal 0 (primeiro canal)
-    const QVector<float>& samples = m_audioFile->getSamples(0);
-    if (samples.isEmpty()) {
+    // O número de amostras define o intervalo desenhado em todas as faixas
+    // (arquivos abertos em fluxo não têm amostras na memória, só resumos)
+    const int totalSamples = m_audioFile->getNumSamples();
+    const bool streamed = m_audioFile->getSamples(0).isEmpty();
+    if (totalSamples <= 0 || (streamed && !m_audioFile->getWaveformSummary(0))) {
         painter.setPen(Qt::red);
         painter.drawText(rect(), Qt::AlignCenter, "Sem dados de áudio");
         return;
     }
     
+    QVector<WaveformLane> lanes = visibleLanes();
+    if (lanes.isEmpty()) {
+        painter.setPen(QColor(150, 150, 150));
+        painter.drawText(rect(), Qt::AlignCenter, "Nenhum canal visível");
+        return;
+    }
+    
     // Calcular qual porção do áudio visualizar
     double totalDuration = m_audioFile->getDuration();
     double viewEndTime = m_viewStartTime + m_viewDuration;
@@ -267,89 +455,212 @@ void AudioVisualizationWidget::drawWaveform(QPainter &painter)
     int endSample = (int)(viewEndTime * sampleRate);
     
     // Garantir limites válidos
-    startSample = qMax(0, qMin(startSample, samples.size() - 1));
-    endSample = qMax(startSample + 1, qMin(endSample, samples.size()));
+    startSample = qMax(0, qMin(startSample, totalSamples - 1));
+    endSample = qMax(startSample + 1, qMin(endSample, totalSamples));
     
     int numSamples = endSample - startSample;
-    int screenWidth = width() - leftMargin;  // Largura disponível para desenho
+    int screenWidth = width() - 50;  // Largura disponível para desenho
+    bool direct = numSamples < screenWidth * 2;
+    
+    // Em fluxo, os resumos bastam enquanto um bloco da pirâmide cabe num
+    // pixel; com mais zoom, apenas o trecho visível (mais as amostras
+    // vizinhas usadas pelo filtro) é lido do arquivo
+    QVector<QVector<float>> windows(m_audioFile->getNumChannels());
+    int windowStart = qMax(0, startSample - (kSincTapsPerSide + 1));
+    int windowEnd = qMin(totalSamples, endSample + kSincTapsPerSide + 1);
+    if (streamed && (direct || WaveformSummary::levelFor(static_cast<double>(numSamples) / screenWidth) < 0)) {
+        for (WaveformLane &lane : lanes) {
+            for (int ch : {lane.firstChannel, lane.secondChannel}) {
+                if (ch >= 0 && windows[ch].isEmpty()
+                    && !readStreamWindow(ch, windowStart, windowEnd - windowStart, windows[ch])) {
+                    painter.setPen(Qt::red);
+                    painter.drawText(rect(), Qt::AlignCenter, "Erro ao ler o arquivo de áudio");
+                    return;
+                }
+            }
+            lane.first = &windows[lane.firstChannel];
+            lane.second = lane.secondChannel >= 0 ? &windows[lane.secondChannel] : nullptr;
+            lane.offset = windowStart;
+        }
+    }
     
     // Desenhar waveform
     painter.setRenderHint(QPainter::Antialiasing, false);  // Mais rápido sem antialiasing
     
-    if (numSamples < screenWidth * 2) {
-        // Poucos samples: desenhar cada um
-        drawWaveformDirect(painter, samples, startSample, endSample, 
-                          leftMargin, topMargin, waveHeight, centerY);
-    } else {
-        // Muitos samples: usar min/max downsampling
-        drawWaveformDownsampled(painter, samples, startSample, endSample,
-                               leftMargin, topMargin, waveHeight, centerY);
+    // Cada faixa custa O(largura): o custo total cresce com faixas x pixels
+    QVector<QRect> areas = laneAreas(lanes.size());
+    for (int i = 0; i < lanes.size(); ++i) {
+        const WaveformLane &lane = lanes[i];
+        const QRect &area = areas[i];
+        if (lane.numSamples < endSample) {
+            continue;
+        }
+        
+        // Desenhar linha central
+        painter.setPen(QPen(QColor(220, 220, 220), 1));
+        painter.drawLine(area.left(), area.center().y(), width(), area.center().y());
+        
+        if (direct) {
+            // Poucos samples: desenhar cada um
+            drawWaveformDirect(painter, lane, startSample, endSample, area);
+        } else {
+            // Muitos samples: usar min/max downsampling
+            drawWaveformDownsampled(painter, lane, startSample, endSample, area);
+        }
+        
+        // Nome da faixa (só com mais de uma)
+        if (lanes.size() > 1) {
+            painter.setPen(QColor(90, 90, 90));
+            painter.setFont(QFont("Arial", 8));
+            painter.drawText(area.adjusted(6, 2, 0, 0), Qt::AlignLeft | Qt::AlignTop, lane.name);
+        }
     }
 }
 
-void AudioVisualizationWidget::drawWaveformDirect(QPainter &painter, 
-                                                  const QVector<float>& samples,
+void AudioVisualizationWidget::drawWaveformDirect(QPainter &painter, const WaveformLane &lane,
                                                   int startSample, int endSample,
-                                                  int leftMargin, int topMargin, int waveHeight, int centerY)
+                                                  const QRect &area)
 {
-    int numSamples = endSample - startSample;
-    int screenWidth = width() - leftMargin;
+    int screenWidth = area.width();
+    int leftMargin = area.left();
+    int waveHeight = area.height();
+    int centerY = area.center().y();
+    int size = lane.numSamples;
     
-    painter.setPen(QPen(QColor(0, 100, 200), 1));
+    // Posição fracionária (em amostras) de cada pixel, alinhada ao eixo de
+    // tempo (timeToPixel) e não ao índice inteiro da primeira amostra
+    double sampleRate = m_audioFile->getSampleRate();
+    double firstPosition = m_viewStartTime * sampleRate;
+    double samplesPerPixel = m_viewDuration * sampleRate / screenWidth;
+    if (samplesPerPixel <= 0.0) return;
     
-    for (int x = 0; x < screenWidth - 1; ++x) {
-        // Mapear pixel para amostra
-        int sampleIdx = startSample + (x * numSamples) / screenWidth;
-        int nextSampleIdx = startSample + ((x + 1) * numSamples) / screenWidth;
-        
-        if (sampleIdx >= samples.size()) break;
-        
-        float sample1 = samples[sampleIdx];
-        float sample2 = (nextSampleIdx < samples.size()) ? samples[nextSampleIdx] : sample1;
+    // Amostras visíveis e as vizinhas usadas pelo filtro, num buffer
+    // contínuo (mid/side calculados apenas aqui)
+    static const SincInterpolator interpolator(kSincTapsPerSide, kSincPhases);
+    int margin = interpolator.tapsPerSide() + 1;
+    int bufferStart = qMax(0, startSample - margin);
+    int bufferEnd = qMin(size, endSample + margin);
+    if (bufferEnd <= bufferStart) return;
+    QVector<float> buffer(bufferEnd - bufferStart);
+    for (int i = bufferStart; i < bufferEnd; ++i) {
+        buffer[i - bufferStart] = lane.sample(i);
+    }
+    
+    // Reconstrução de banda limitada, um valor por pixel: mostra os picos
+    // entre amostras que a ligação em linha reta esconde
+    QVector<QLine> lines;
+    lines.reserve(qMax(0, screenWidth));
+    int previousY = centerY;
+    for (int x = 0; x < screenWidth; ++x) {
+        double position = firstPosition + x * samplesPerPixel;
+        if (position >= size) break;
         
-        // Converter amplitude (-1 a 1) para coordenadas Y
-        int y1 = centerY - (int)(sample1 * waveHeight / 2);
-        int y2 = centerY - (int)(sample2 * waveHeight / 2);
+        float value = interpolator.valueAt(buffer.constData(), buffer.size(), position - bufferStart);
+        int y = centerY - (int)(value * waveHeight / 2);
+        if (x > 0) {
+            lines.append(QLine(leftMargin + x - 1, previousY, leftMargin + x, y));
+        }
+        previousY = y;
+    }
+    painter.setPen(QPen(QColor(0, 100, 200), 1));
+    painter.drawLines(lines);
+    
+    // Posições das amostras (haste e ponto), quando há espaço entre elas
+    double pixelsPerSample = 1.0 / samplesPerPixel;
+    if (pixelsPerSample < kMinSampleMarkerSpacing) return;
+    
+    QVector<QLine> stems;
+    QPolygon points;
+    for (int n = qMax(bufferStart, (int)std::ceil(firstPosition)); n < bufferEnd; ++n) {
+        double x = (n - firstPosition) * pixelsPerSample;
+        if (x >= screenWidth) break;
         
-        painter.drawLine(leftMargin + x, y1, leftMargin + x + 1, y2);
+        int px = leftMargin + (int)std::lround(x);
+        int y = centerY - (int)(buffer[n - bufferStart] * waveHeight / 2);
+        stems.append(QLine(px, centerY, px, y));
+        points.append(QPoint(px, y));
     }
+    painter.setPen(QPen(QColor(0, 100, 200, 90), 1));
+    painter.drawLines(stems);
+    painter.setPen(QPen(QColor(0, 100, 200), 4, Qt::SolidLine, Qt::RoundCap));
+    painter.drawPoints(points);
 }
 
-void AudioVisualizationWidget::drawWaveformDownsampled(QPainter &painter,
-                                                       const QVector<float>& samples,
+void AudioVisualizationWidget::drawWaveformDownsampled(QPainter &painter, const WaveformLane &lane,
                                                        int startSample, int endSample,
-                                                       int leftMargin, int topMargin, int waveHeight, int centerY)
+                                                       const QRect &area)
 {
     int numSamples = endSample - startSample;
-    int screenWidth = width() - leftMargin;
+    int screenWidth = area.width();
+    int leftMargin = area.left();
+    int waveHeight = area.height();
+    int centerY = area.center().y();
+    int size = lane.numSamples;
     
-    painter.setPen(QPen(QColor(0, 100, 200), 1));
+    // Nível da pirâmide com blocos de até um pixel: cada pixel combina
+    // poucos blocos, e o custo depende só da largura do widget. Abaixo do
+    // menor bloco (ou sem pirâmide) as amostras são percorridas
+    const WaveformSummary *summary = lane.summary.get();
+    int level = -1;
+    if (summary && summary->numSamples() == size) {
+        level = WaveformSummary::levelFor(static_cast<double>(numSamples) / screenWidth);
+    }
+    
+    // Uma linha vertical por pixel para o pico e outra, mais clara, para o
+    // RMS; cada conjunto desenhado numa única chamada
+    QVector<QLine> lines;
+    QVector<QLine> rmsLines;
+    lines.reserve(qMax(0, screenWidth));
+    rmsLines.reserve(qMax(0, screenWidth));
     
     // Para cada pixel, calcular min e max das amostras correspondentes
     for (int x = 0; x < screenWidth; ++x) {
-        // Calcular faixa de amostras para este pixel
-        int sampleStart = startSample + (x * numSamples) / screenWidth;
-        int sampleEnd = startSample + ((x + 1) * numSamples) / screenWidth;
+        // Calcular faixa de amostras para este pixel (64 bits: x * numSamples
+        // estoura int em arquivos longos)
+        int sampleStart = startSample + static_cast<int>((static_cast<qint64>(x) * numSamples) / screenWidth);
+        int sampleEnd = startSample + static_cast<int>((static_cast<qint64>(x + 1) * numSamples) / screenWidth);
         
-        if (sampleStart >= samples.size()) break;
-        sampleEnd = qMin(sampleEnd, samples.size());
+        if (sampleStart >= size) break;
+        sampleEnd = qMin(sampleEnd, size);
         
         // Encontrar min e max nesta faixa
         float minVal = 0.0f;
         float maxVal = 0.0f;
+        float rms = 0.0f;
         
-        for (int i = sampleStart; i < sampleEnd; ++i) {
-            float sample = samples[i];
-            minVal = qMin(minVal, sample);
-            maxVal = qMax(maxVal, sample);
+        if (level >= 0) {
+            WaveformSummary::Block block = summary->range(level, sampleStart, sampleEnd);
+            minVal = qMin(minVal, block.min);
+            maxVal = qMax(maxVal, block.max);
+            rms = block.rms;
+        } else {
+            double sumSquares = 0.0;
+            for (int i = sampleStart; i < sampleEnd; ++i) {
+                float sample = lane.sample(i);
+                minVal = qMin(minVal, sample);
+                maxVal = qMax(maxVal, sample);
+                sumSquares += static_cast<double>(sample) * sample;
+            }
+            if (sampleEnd > sampleStart) {
+                rms = static_cast<float>(std::sqrt(sumSquares / (sampleEnd - sampleStart)));
+            }
         }
         
         // Desenhar linha vertical do min ao max
         int yMin = centerY - (int)(maxVal * waveHeight / 2);
         int yMax = centerY - (int)(minVal * waveHeight / 2);
+        lines.append(QLine(leftMargin + x, yMin, leftMargin + x, yMax));
         
-        painter.drawLine(leftMargin + x, yMin, leftMargin + x, yMax);
+        int rmsHeight = (int)(qMin(rms, qMax(maxVal, -minVal)) * waveHeight / 2);
+        if (rmsHeight > 0) {
+            rmsLines.append(QLine(leftMargin + x, centerY - rmsHeight, leftMargin + x, centerY + rmsHeight));
+        }
     }
+    
+    painter.setPen(QPen(QColor(0, 100, 200), 1));
+    painter.drawLines(lines);
+    painter.setPen(QPen(QColor(110, 170, 235), 1));
+    painter.drawLines(rmsLines);
 }
 
 void AudioVisualizationWidget::drawAmplitudeAxis(QPainter &painter)
@@ -357,30 +668,32 @@ void AudioVisualizationWidget::drawAmplitudeAxis(QPainter &painter)
     if (!m_audioFile) return;
     
     int leftMargin = 50;
-    int topMargin = 35;
-    int bottomMargin = 25;
-    int drawHeight = height() - topMargin - bottomMargin;
-    int centerY = topMargin + drawHeight / 2;
     
     painter.setPen(Qt::black);
     painter.setFont(QFont("Arial", 8));
     
-    // Desenhar escala de amplitude (-1.0 a 1.0)
-    int numTicks = 5;
-    
-    for (int i = 0; i <= numTicks; ++i) {
-        // Amplitude de -1.0 (topo) a 1.0 (baixo)
-        float amplitude = 1.0f - (2.0f * i / numTicks);
-        int y = topMargin + (i * drawHeight / numTicks);
+    for (const QRect &area : laneAreas(visibleLanes().size())) {
+        int topMargin = area.top();
+        int drawHeight = area.height();
         
-        // Linha de marcação
-        painter.drawLine(leftMargin - 5, y, leftMargin, y);
+        // Desenhar escala de amplitude (-1.0 a 1.0); faixas baixas só com
+        // os extremos e o zero
+        int numTicks = drawHeight >= 120 ? 5 : 2;
         
-        // Texto da amplitude
-        QString label = QString::number(amplitude, 'f', 1);
-        painter.drawText(QRect(0, y - 10, leftMargin - 10, 20), 
-                        Qt::AlignRight | Qt::AlignVCenter,
-                        label);
+        for (int i = 0; i <= numTicks; ++i) {
+            // Amplitude de -1.0 (topo) a 1.0 (baixo)
+            float amplitude = 1.0f - (2.0f * i / numTicks);
+            int y = topMargin + (i * drawHeight / numTicks);
+            
+            // Linha de marcação
+            painter.drawLine(leftMargin - 5, y, leftMargin, y);
+            
+            // Texto da amplitude
+            QString label = QString::number(amplitude, 'f', 1);
+            painter.drawText(QRect(0, y - 10, leftMargin - 10, 20), 
+                            Qt::AlignRight | Qt::AlignVCenter,
+                            label);
+        }
     }
 }
 
@@ -465,13 +778,11 @@ void AudioVisualizationWidget::drawSelection(QPainter &painter)
 
 void AudioVisualizationWidget::drawPlaybackCursor(QPainter &painter)
 {
-    if (!m_isPlaying || !m_audioFile) return;
-    
     // Converter posição de reprodução para pixel
-    int cursorX = timeToPixel(m_playbackPosition);
+    int cursorX = playbackCursorX();
     
     // Verificar se o cursor está visível
-    if (cursorX < 0 || cursorX > width()) return;
+    if (cursorX < 0) return;
     
     // Desenhar linha vertical vermelha
     painter.setPen(QPen(QColor(255, 0, 0), 2));
@@ -486,6 +797,38 @@ void AudioVisualizationWidget::drawPlaybackCursor(QPainter &painter)
     painter.drawPolygon(triangle);
 }
 
+int AudioVisualizationWidget::playbackCursorX() const
+{
+    if (!m_isPlaying || !m_audioFile) {
+        return -1;
+    }
+    int cursorX = timeToPixel(m_playbackPosition);
+    return (cursorX < 0 || cursorX > width()) ? -1 : cursorX;
+}
+
+QRect AudioVisualizationWidget::playbackCursorRect(int x) const
+{
+    // Linha de 2 px e triângulo de 10 px, mais uma margem para o antialiasing
+    return QRect(x - 6, 0, 13, height());
+}
+
+void AudioVisualizationWidget::updatePlaybackCursor()
+{
+    // Apenas as colunas sob a posição anterior e a nova do cursor são
+    // repintadas; o restante vem da imagem em cache
+    int currentX = playbackCursorX();
+    if (currentX == m_playbackCursorX) {
+        return;
+    }
+    if (m_playbackCursorX >= 0) {
+        update(playbackCursorRect(m_playbackCursorX));
+    }
+    if (currentX >= 0) {
+        update(playbackCursorRect(currentX));
+    }
+    m_playbackCursorX = currentX;
+}
+
 void AudioVisualizationWidget::drawMouseCursor(QPainter &painter)
 {
     if (!m_audioFile) return;
@@ -501,6 +844,20 @@ void AudioVisualizationWidget::drawMouseCursor(QPainter &painter)
     painter.drawLine(cursorX, 35, cursorX, height() - 25);
 }
 
+QRect AudioVisualizationWidget::mouseCursorRect(int x) const
+{
+    return QRect(x - 1, 0, 3, height());
+}
+
+void AudioVisualizationWidget::updateMouseCursor(const QPoint &previousPos)
+{
+    // Linha do cursor nas posições anterior e atual, e o tempo sob o mouse
+    // no cabeçalho
+    update(mouseCursorRect(previousPos.x()));
+    update(mouseCursorRect(m_currentMousePos.x()));
+    update(windowInfoRect());
+}
+
 void AudioVisualizationWidget::mousePressEvent(QMouseEvent *event)
 {
     if (!m_audioFile) return;
@@ -531,10 +888,10 @@ void AudioVisualizationWidget::mousePressEvent(QMouseEvent *event)
 void AudioVisualizationWidget::mouseMoveEvent(QMouseEvent *event)
 {
     // Atualizar posição do mouse
+    QPoint previousPos = m_currentMousePos;
     m_currentMousePos = event->pos();
     
     if (!m_audioFile) {
-        update();
         return;
     }
     
@@ -543,7 +900,7 @@ void AudioVisualizationWidget::mouseMoveEvent(QMouseEvent *event)
         double currentTime = pixelToTime(event->pos().x());
         m_selectionEnd = currentTime;
         
-        update();
+        invalidateWaveform();
         // NÃO emitir sinal aqui - só no mouseRelease
     } else if (m_isDragging) {
         // Pan horizontal - arrastar para navegar
@@ -564,11 +921,11 @@ void AudioVisualizationWidget::mouseMoveEvent(QMouseEvent *event)
             m_viewStartTime = maxDuration - m_viewDuration;
         }
         
-        update();
+        invalidateWaveform();
         emit visibleTimeRangeChanged(m_viewStartTime, m_viewStartTime + m_viewDuration);
     } else {
-        // Apenas atualizar para redesenhar o cursor
-        update();
+        // Apenas redesenhar o cursor
+        updateMouseCursor(previousPos);
     }
 }
 
@@ -623,13 +980,14 @@ void AudioVisualizationWidget::wheelEvent(QWheelEvent *event)
         m_viewStartTime = maxDuration - m_viewDuration;
     }
     
-    update();
+    invalidateWaveform();
     emit visibleTimeRangeChanged(m_viewStartTime, m_viewStartTime + m_viewDuration);
 }
 
 void AudioVisualizationWidget::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
+    invalidateWaveform();
 }
 
 void AudioVisualizationWidget::keyPressEvent(QKeyEvent *event)
@@ -642,6 +1000,33 @@ void AudioVisualizationWidget::keyPressEvent(QKeyEvent *event)
     QWidget::keyPressEvent(event);
 }
 
+void AudioVisualizationWidget::contextMenuEvent(QContextMenuEvent *event)
+{
+    if (!m_audioFile) {
+        return;
+    }
+    
+    // Faixas visíveis: um item marcável por canal, mais mid/side
+    QMenu menu(this);
+    int numChannels = m_audioFile->getNumChannels();
+    for (int ch = 0; ch < numChannels; ++ch) {
+        QAction *action = menu.addAction(QString("Canal %1").arg(ch + 1));
+        action->setCheckable(true);
+        action->setChecked(isChannelVisible(ch));
+        connect(action, &QAction::toggled, this, [this, ch](bool checked) {
+            setChannelVisible(ch, checked);
+        });
+    }
+    menu.addSeparator();
+    QAction *midSideAction = menu.addAction("Mid/Side (canais 1 e 2)");
+    midSideAction->setCheckable(true);
+    midSideAction->setChecked(m_showMidSide);
+    midSideAction->setEnabled(numChannels >= 2);
+    connect(midSideAction, &QAction::toggled, this, &AudioVisualizationWidget::setMidSideVisible);
+    
+    menu.exec(event->globalPos());
+}
+
 double AudioVisualizationWidget::pixelToTime(int pixel) const
 {
     int leftMargin = 50;
@@ -664,15 +1049,17 @@ void AudioVisualizationWidget::updateSpectrogramVisibility()
 
 void AudioVisualizationWidget::enterEvent(QEnterEvent *event)
 {
+    QPoint previousPos = m_currentMousePos;
+    m_currentMousePos = event->position().toPoint();
     m_mouseInWidget = true;
-    update();
+    updateMouseCursor(previousPos);
     QWidget::enterEvent(event);
 }
 
 void AudioVisualizationWidget::leaveEvent(QEvent *event)
 {
     m_mouseInWidget = false;
-    update();
+    updateMouseCursor(m_currentMousePos);
     QWidget::leaveEvent(event);
 }
 
@@ -694,5 +1081,5 @@ void AudioVisualizationWidget::setPlaying(bool playing)
         m_updateTimer->stop();
         LOG_AUDIO("Timer de atualização PARADO");
     }
-    update();
+    updatePlaybackCursor();
 }
@@ -1,6 +1,7 @@
 #include "views/MainWindow.h"
 #include "views/AudioListWidget.h"
 #include "views/AudioVisualizationWidget.h"
+#include "views/AudioOverviewWidget.h"
 #include "views/SpectrogramWidget.h"
 #include "views/SpectrogramSettingsDialog.h"
 #include "views/AnnotationLayerWidget.h"
@@ -14,6 +15,7 @@
 #include "audio/AudioDecoder.h"
 #include "audio/AudioDecoderWorker.h"
 #include "audio/CustomAudioPlayer.h"
+#include "audio/SpectrogramPrefetcher.h"
 
 #include <QMenuBar>
 #include <QMenu>
@@ -38,10 +40,12 @@ MainWindow::MainWindow(QWidget *parent)
     , m_centralSplitter(nullptr)
     , m_audioListWidget(nullptr)
     , m_audioVisualizationWidget(nullptr)
+    , m_audioOverviewWidget(nullptr)
     , m_spectrogramWidget(nullptr)
     , m_annotationLayerWidget(nullptr)
     , m_audioControlWidget(nullptr)
     , m_audioPlayer(nullptr)
+    , m_spectrogramPrefetcher(nullptr)
 {
     // Create project and controllers
     m_project = std::make_shared<Project>();
@@ -52,6 +56,9 @@ MainWindow::MainWindow(QWidget *parent)
     // Create audio player
     m_audioPlayer = new CustomAudioPlayer(this);
     
+    // Pré-cálculo dos espectrogramas de arquivos vizinhos e recentes
+    m_spectrogramPrefetcher = new SpectrogramPrefetcher(this);
+    
     // Setup UI
     createActions();
     createMenus();
@@ -131,6 +138,12 @@ void MainWindow::setupLayout()
     m_centralSplitter->setStretchFactor(1, 2);  // Spectrogram
     m_centralSplitter->setStretchFactor(1, 1);  // Annotations
     
+    // Faixa de visão geral do arquivo inteiro, acima da forma de onda
+    m_audioOverviewWidget = new AudioOverviewWidget(this);
+    m_overviewSpectrogramAction->setChecked(m_audioOverviewWidget->isShowingSpectrogram());
+    updateOverviewSpectrogram();
+    centralLayout->addWidget(m_audioOverviewWidget);
+    
     // Add splitter to central panel
     centralLayout->addWidget(m_centralSplitter);
     
@@ -214,6 +227,28 @@ void MainWindow::createActions()
     m_spectrogramSettingsAction->setStatusTip("Configurar parâmetros do espectrograma");
     connect(m_spectrogramSettingsAction, &QAction::triggered, this, &MainWindow::onSpectrogramSettings);
     
+    m_toggleDualAnalysisAction = new QAction("Alternar &Janela Larga/Estreita", this);
+    m_toggleDualAnalysisAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_B));
+    m_toggleDualAnalysisAction->setStatusTip("Alternar entre as duas janelas da análise dupla (sem recalcular)");
+    connect(m_toggleDualAnalysisAction, &QAction::triggered, [this]() {
+        m_spectrogramWidget->toggleDualAnalysis();
+    });
+    
+    m_overviewSpectrogramAction = new QAction("Espectrograma na &Visão Geral", this);
+    m_overviewSpectrogramAction->setCheckable(true);
+    m_overviewSpectrogramAction->setStatusTip("Mostrar uma miniatura do espectrograma do arquivo inteiro na faixa de visão geral");
+    connect(m_overviewSpectrogramAction, &QAction::toggled, [this](bool checked) {
+        m_audioOverviewWidget->setShowSpectrogram(checked);
+    });
+    
+    m_prefetchSpectrogramsAction = new QAction("&Pré-calcular Espectrogramas", this);
+    m_prefetchSpectrogramsAction->setCheckable(true);
+    m_prefetchSpectrogramsAction->setChecked(!m_spectrogramPrefetcher->isPaused());
+    m_prefetchSpectrogramsAction->setStatusTip("Calcular em segundo plano o espectrograma dos arquivos vizinhos e recentes");
+    connect(m_prefetchSpectrogramsAction, &QAction::toggled, [this](bool checked) {
+        m_spectrogramPrefetcher->setPaused(!checked);
+    });
+    
     m_zoomInAction = new QAction("Ampliar (&+)", this);
     m_zoomInAction->setShortcut(QKeySequence::ZoomIn);
     m_zoomInAction->setStatusTip("Ampliar visualização da forma de onda");
@@ -291,6 +326,9 @@ void MainWindow::createMenus()
     m_viewMenu = menuBar()->addMenu("&Visualizar");
     m_viewMenu->addAction(m_showSpectrogramAction);
     m_viewMenu->addAction(m_spectrogramSettingsAction);
+    m_viewMenu->addAction(m_toggleDualAnalysisAction);
+    m_viewMenu->addAction(m_prefetchSpectrogramsAction);
+    m_viewMenu->addAction(m_overviewSpectrogramAction);
     m_viewMenu->addSeparator();
     m_viewMenu->addAction(m_zoomInAction);
     m_viewMenu->addAction(m_zoomOutAction);
@@ -371,9 +409,14 @@ void MainWindow::connectSignals()
                 
                 // Configurar novo arquivo
                 m_audioVisualizationWidget->setAudioFile(audioFile);
+                m_audioOverviewWidget->setAudioFile(audioFile);
                 m_spectrogramWidget->setAudioFile(audioFile);
                 m_audioPlayer->setAudioFile(audioFile);
                 
+                m_spectrogramPrefetcher->setViewport(m_spectrogramWidget->calculatorParameters(),
+                                                     m_spectrogramWidget->plotWidth());
+                m_spectrogramPrefetcher->fileSelected(audioFile, m_project->getAudioFiles());
+                
                 if (audioFile) {
                     m_audioControlWidget->setDuration(audioFile->getDuration());
                 } else {
@@ -395,8 +438,34 @@ void MainWindow::connectSignals()
             [this](double startTime, double duration) {
                 m_audioVisualizationWidget->setVisibleTimeRange(startTime, duration);
                 m_annotationLayerWidget->setVisibleTimeRange(startTime, startTime + duration);
+                m_audioOverviewWidget->setVisibleTimeRange(startTime, duration);
             });
     
+    // Visão geral: acompanha o trecho visível e o move ao clicar/arrastar
+    connect(m_audioVisualizationWidget, &AudioVisualizationWidget::visibleTimeRangeChanged,
+            [this](double startTime, double endTime) {
+                m_audioOverviewWidget->setVisibleTimeRange(startTime, endTime - startTime);
+            });
+    connect(m_audioOverviewWidget, &AudioOverviewWidget::visibleTimeRangeChanged,
+            [this](double startTime, double duration) {
+                m_audioVisualizationWidget->setVisibleTimeRange(startTime, duration);
+                m_spectrogramWidget->setVisibleTimeRange(startTime, duration);
+                m_annotationLayerWidget->setVisibleTimeRange(startTime, startTime + duration);
+            });
+    
+    // Valor do espectrograma sob o cursor
+    connect(m_spectrogramWidget, &SpectrogramWidget::cursorValueChanged,
+            [this](double timeSeconds, double frequency, double db) {
+                updateStatusBar(QString("%1 s  |  %2 Hz  |  %3 dB")
+                                .arg(timeSeconds, 0, 'f', 3)
+                                .arg(frequency, 0, 'f', 0)
+                                .arg(db, 0, 'f', 1));
+            });
+    
+    // O pré-cálculo espera enquanto o espectrograma visível é calculado
+    connect(m_spectrogramWidget, &SpectrogramWidget::calculatingChanged,
+            m_spectrogramPrefetcher, &SpectrogramPrefetcher::setForegroundActive);
+    
     // Connect selection to player region
     connect(m_audioVisualizationWidget, &AudioVisualizationWidget::timeSelectionChanged,
             [this](double startTime, double endTime) {
@@ -624,17 +693,23 @@ void MainWindow::onSpectrogramSettings()
     SpectrogramSettingsDialog::Settings dialogSettings;
     dialogSettings.timeStep = currentSettings.timeStep;
     dialogSettings.timeWindow = currentSettings.timeWindow;
+    dialogSettings.secondaryTimeWindow = currentSettings.secondaryTimeWindow;
     dialogSettings.fftSize = currentSettings.fftSize;
     dialogSettings.windowType = currentSettings.windowType;
     dialogSettings.minFrequency = currentSettings.minFrequency;
     dialogSettings.maxFrequency = currentSettings.maxFrequency;
     dialogSettings.dynamicRange = currentSettings.dynamicRange;
     dialogSettings.colorMap = currentSettings.colorMap;
+    dialogSettings.frequencyScale = currentSettings.frequencyScale;
+    dialogSettings.dualDisplay = currentSettings.dualDisplay;
     dialogSettings.preEmphasis = currentSettings.preEmphasis;
     dialogSettings.preEmphasisFactor = currentSettings.preEmphasisFactor;
     
     // Mostrar diálogo
     SpectrogramSettingsDialog dialog(dialogSettings, this);
+    dialog.setPreviewSource(m_spectrogramWidget->getAudioFile(),
+                            m_spectrogramWidget->getViewStartTime(),
+                            m_spectrogramWidget->getViewDuration());
     if (dialog.exec() == QDialog::Accepted) {
         // Aplicar novas configurações
         SpectrogramSettingsDialog::Settings newSettings = dialog.getSettings();
@@ -642,24 +717,37 @@ void MainWindow::onSpectrogramSettings()
         SpectrogramWidget::Settings widgetSettings;
         widgetSettings.timeStep = newSettings.timeStep;
         widgetSettings.timeWindow = newSettings.timeWindow;
+        widgetSettings.secondaryTimeWindow = newSettings.secondaryTimeWindow;
         widgetSettings.fftSize = newSettings.fftSize;
         widgetSettings.windowType = newSettings.windowType;
         widgetSettings.minFrequency = newSettings.minFrequency;
         widgetSettings.maxFrequency = newSettings.maxFrequency;
         widgetSettings.dynamicRange = newSettings.dynamicRange;
         widgetSettings.colorMap = newSettings.colorMap;
+        widgetSettings.frequencyScale = newSettings.frequencyScale;
+        widgetSettings.dualDisplay = newSettings.dualDisplay;
         widgetSettings.preEmphasis = newSettings.preEmphasis;
         widgetSettings.preEmphasisFactor = newSettings.preEmphasisFactor;
         
         m_spectrogramWidget->setSettings(widgetSettings);
+        updateOverviewSpectrogram();
+        m_spectrogramPrefetcher->setViewport(m_spectrogramWidget->calculatorParameters(),
+                                             m_spectrogramWidget->plotWidth());
         
-        // Recalcular espectrograma se houver áudio carregado
-        if (m_spectrogramWidget->isCalculating() == false) {
-            m_spectrogramWidget->calculateSpectrogram();
-        }
+        // Recalcular espectrograma se houver áudio carregado (um pedido
+        // idêntico ao que já está em andamento é ignorado)
+        m_spectrogramWidget->calculateSpectrogram();
     }
 }
 
+void MainWindow::updateOverviewSpectrogram()
+{
+    SpectrogramWidget::Settings settings = m_spectrogramWidget->getSettings();
+    m_audioOverviewWidget->setSpectrogramSettings(m_spectrogramWidget->calculatorParameters(),
+                                                  settings.dynamicRange, settings.colorMap,
+                                                  settings.frequencyScale);
+}
+
 void MainWindow::onZoomIn() {
     m_audioVisualizationWidget->zoom(1.5);
 }
@@ -1,4 +1,6 @@
 #include "views/SpectrogramSettingsDialog.h"
+#include "audio/FrequencyScale.h"
+#include "models/AudioFile.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -9,20 +11,58 @@
 #include <QCheckBox>
 #include <QPushButton>
 #include <QLabel>
+#include <QPainter>
+#include <QPixmap>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+    // Colunas e altura da prévia (a imagem é esticada até o tamanho do rótulo)
+    const int kPreviewColumns = 480;
+    const int kPreviewHeight = 140;
+}
 
 SpectrogramSettingsDialog::SpectrogramSettingsDialog(const Settings &currentSettings, QWidget *parent)
     : QDialog(parent)
+    , m_previewLabel(nullptr)
+    , m_previewStartTime(0.0)
+    , m_previewDuration(0.0)
+    , m_previewGeneration(0)
+    , m_previewPending(false)
 {
+    connect(&m_previewWatcher, &QFutureWatcher<QVector<SpectrogramTile>>::finished,
+            this, &SpectrogramSettingsDialog::onPreviewFinished);
+    
     setupUI();
     loadSettings(currentSettings);
     
     setWindowTitle("Configurações do Espectrograma");
     setModal(true);
-    resize(500, 600);
+    resize(500, 760);
 }
 
 SpectrogramSettingsDialog::~SpectrogramSettingsDialog()
 {
+    // Interromper a prévia em andamento (ela referencia o diálogo)
+    ++m_previewGeneration;
+    m_previewWatcher.waitForFinished();
+}
+
+void SpectrogramSettingsDialog::setPreviewSource(std::shared_ptr<AudioFile> audioFile,
+                                                 double startTime, double duration)
+{
+    m_previewFile = audioFile;
+    m_previewStartTime = startTime;
+    m_previewDuration = duration;
+    m_previewTiles.clear();
+    
+    if (!m_previewFile || m_previewDuration <= 0.0) {
+        m_previewFile.reset();
+        m_previewLabel->setPixmap(QPixmap());
+        m_previewLabel->setText("Nenhum áudio selecionado");
+        return;
+    }
+    requestPreview();
 }
 
 void SpectrogramSettingsDialog::setupUI()
@@ -49,6 +89,15 @@ void SpectrogramSettingsDialog::setupUI()
     m_timeWindowSpinBox->setSuffix(" s");
     calcLayout->addRow("Janela de Tempo:", m_timeWindowSpinBox);
     
+    // Análise dupla: segunda janela calculada na mesma passada
+    m_secondaryTimeWindowSpinBox = new QDoubleSpinBox(this);
+    m_secondaryTimeWindowSpinBox->setRange(0.0, 1.0);
+    m_secondaryTimeWindowSpinBox->setSingleStep(0.001);
+    m_secondaryTimeWindowSpinBox->setDecimals(3);
+    m_secondaryTimeWindowSpinBox->setSuffix(" s");
+    m_secondaryTimeWindowSpinBox->setSpecialValueText("Desligada");
+    calcLayout->addRow("Segunda Janela:", m_secondaryTimeWindowSpinBox);
+    
     // FFT size - apenas potências de 2
     m_fftSizeComboBox = new QComboBox(this);
     m_fftSizeComboBox->addItem("256", 256);
@@ -92,6 +141,16 @@ void SpectrogramSettingsDialog::setupUI()
     m_colorMapComboBox->addItems({"Grayscale", "Jet", "Hot", "Cool", "Viridis"});
     vizLayout->addRow("Mapa de Cores:", m_colorMapComboBox);
     
+    m_frequencyScaleComboBox = new QComboBox(this);
+    m_frequencyScaleComboBox->addItems(FrequencyScale::names());
+    vizLayout->addRow("Escala de Frequência:", m_frequencyScaleComboBox);
+    
+    m_dualDisplayComboBox = new QComboBox(this);
+    m_dualDisplayComboBox->addItem("Janela Principal", "Primary");
+    m_dualDisplayComboBox->addItem("Segunda Janela", "Secondary");
+    m_dualDisplayComboBox->addItem("Empilhadas", "Stacked");
+    vizLayout->addRow("Análise Dupla:", m_dualDisplayComboBox);
+    
     mainLayout->addWidget(vizGroup);
     
     // Grupo: Pré-ênfase
@@ -112,6 +171,31 @@ void SpectrogramSettingsDialog::setupUI()
     
     mainLayout->addWidget(preEmphGroup);
     
+    // Grupo: Prévia
+    QGroupBox *previewGroup = new QGroupBox("Prévia", this);
+    QVBoxLayout *previewLayout = new QVBoxLayout(previewGroup);
+    
+    m_previewLabel = new QLabel("Nenhum áudio selecionado", this);
+    m_previewLabel->setAlignment(Qt::AlignCenter);
+    m_previewLabel->setFixedHeight(kPreviewHeight);
+    m_previewLabel->setMinimumWidth(200);
+    m_previewLabel->setScaledContents(true);
+    previewLayout->addWidget(m_previewLabel);
+    
+    mainLayout->addWidget(previewGroup);
+    
+    // Qualquer mudança atualiza a prévia
+    for (QDoubleSpinBox *spinBox : {m_timeStepSpinBox, m_timeWindowSpinBox, m_secondaryTimeWindowSpinBox,
+                                    m_minFreqSpinBox, m_maxFreqSpinBox, m_dynamicRangeSpinBox,
+                                    m_preEmphasisFactorSpinBox}) {
+        connect(spinBox, &QDoubleSpinBox::valueChanged, this, &SpectrogramSettingsDialog::onSettingsChanged);
+    }
+    for (QComboBox *comboBox : {m_fftSizeComboBox, m_windowTypeComboBox, m_colorMapComboBox,
+                                m_frequencyScaleComboBox, m_dualDisplayComboBox}) {
+        connect(comboBox, &QComboBox::currentIndexChanged, this, &SpectrogramSettingsDialog::onSettingsChanged);
+    }
+    connect(m_preEmphasisCheckBox, &QCheckBox::toggled, this, &SpectrogramSettingsDialog::onSettingsChanged);
+    
     mainLayout->addStretch();
     
     // Botões
@@ -141,6 +225,7 @@ void SpectrogramSettingsDialog::loadSettings(const Settings &settings)
 {
     m_timeStepSpinBox->setValue(settings.timeStep);
     m_timeWindowSpinBox->setValue(settings.timeWindow);
+    m_secondaryTimeWindowSpinBox->setValue(settings.secondaryTimeWindow);
     
     // Encontrar o índice do FFT size no combo box
     int fftIndex = m_fftSizeComboBox->findData(settings.fftSize);
@@ -154,6 +239,9 @@ void SpectrogramSettingsDialog::loadSettings(const Settings &settings)
     m_maxFreqSpinBox->setValue(settings.maxFrequency);
     m_dynamicRangeSpinBox->setValue(settings.dynamicRange);
     m_colorMapComboBox->setCurrentText(settings.colorMap);
+    m_frequencyScaleComboBox->setCurrentText(settings.frequencyScale);
+    int dualIndex = m_dualDisplayComboBox->findData(settings.dualDisplay);
+    m_dualDisplayComboBox->setCurrentIndex(std::max(0, dualIndex));
     
     m_preEmphasisCheckBox->setChecked(settings.preEmphasis);
     m_preEmphasisFactorSpinBox->setValue(settings.preEmphasisFactor);
@@ -165,6 +253,7 @@ SpectrogramSettingsDialog::Settings SpectrogramSettingsDialog::getSettings() con
     
     settings.timeStep = m_timeStepSpinBox->value();
     settings.timeWindow = m_timeWindowSpinBox->value();
+    settings.secondaryTimeWindow = m_secondaryTimeWindowSpinBox->value();
     settings.fftSize = m_fftSizeComboBox->currentData().toInt();
     settings.windowType = m_windowTypeComboBox->currentText();
     
@@ -172,6 +261,8 @@ SpectrogramSettingsDialog::Settings SpectrogramSettingsDialog::getSettings() con
     settings.maxFrequency = m_maxFreqSpinBox->value();
     settings.dynamicRange = m_dynamicRangeSpinBox->value();
     settings.colorMap = m_colorMapComboBox->currentText();
+    settings.frequencyScale = m_frequencyScaleComboBox->currentText();
+    settings.dualDisplay = m_dualDisplayComboBox->currentData().toString();
     
     settings.preEmphasis = m_preEmphasisCheckBox->isChecked();
     settings.preEmphasisFactor = m_preEmphasisFactorSpinBox->value();
@@ -186,6 +277,7 @@ SpectrogramSettingsDialog::Settings SpectrogramSettingsDialog::getDefaultSetting
     // Padrões otimizados
     defaults.timeStep = 0.01;         // 10 ms
     defaults.timeWindow = 0.03;       // 30 ms
+    defaults.secondaryTimeWindow = 0.0; // Análise simples
     defaults.fftSize = 1024;          // Será ajustado para potência de 2
     defaults.windowType = "Hamming";
     
@@ -193,6 +285,8 @@ SpectrogramSettingsDialog::Settings SpectrogramSettingsDialog::getDefaultSetting
     defaults.maxFrequency = 4000.0;   // 4 kHz
     defaults.dynamicRange = 90.0;     // 90 dB
     defaults.colorMap = "Grayscale";
+    defaults.frequencyScale = "Linear";
+    defaults.dualDisplay = "Primary";
     
     defaults.preEmphasis = false;
     defaults.preEmphasisFactor = 0.97;
@@ -209,3 +303,149 @@ void SpectrogramSettingsDialog::updatePreEmphasisState(int state)
 {
     m_preEmphasisFactorSpinBox->setEnabled(state == Qt::Checked);
 }
+
+SpectrogramCalculator::Parameters SpectrogramSettingsDialog::calculatorParameters() const
+{
+    Settings settings = getSettings();
+    SpectrogramCalculator::Parameters params;
+    params.timeStep = settings.timeStep;
+    params.timeWindow = settings.timeWindow;
+    params.fftSize = settings.fftSize;
+    params.windowType = SpectrogramCalculator::windowTypeFromName(settings.windowType);
+    params.minFrequency = settings.minFrequency;
+    params.maxFrequency = settings.maxFrequency;
+    params.preEmphasis = settings.preEmphasis;
+    params.preEmphasisFactor = settings.preEmphasisFactor;
+    params.secondaryTimeWindow = settings.secondaryTimeWindow;
+    return params;
+}
+
+void SpectrogramSettingsDialog::onSettingsChanged()
+{
+    if (!m_previewFile) {
+        return;
+    }
+    
+    // Faixa dinâmica, cores, escala e análise exibida mudam apenas a imagem
+    if (calculatorParameters() == m_requestedParams) {
+        updatePreviewImage();
+    } else {
+        requestPreview();
+    }
+}
+
+void SpectrogramSettingsDialog::requestPreview()
+{
+    if (!m_previewFile) {
+        return;
+    }
+    
+    // A prévia em andamento fica obsoleta e para na próxima coluna; a nova
+    // começa quando ela terminar
+    m_requestedParams = calculatorParameters();
+    ++m_previewGeneration;
+    if (m_previewWatcher.isRunning()) {
+        m_previewPending = true;
+        return;
+    }
+    startPreview();
+}
+
+void SpectrogramSettingsDialog::startPreview()
+{
+    m_previewPending = false;
+    m_runningParams = m_requestedParams;
+    
+    const quint64 generation = m_previewGeneration.load();
+    const std::shared_ptr<AudioFile> audioFile = m_previewFile;
+    const SpectrogramCalculator::Parameters params = m_runningParams;
+    const double startTime = m_previewStartTime;
+    const double duration = m_previewDuration;
+    
+    // Na análise dupla as duas janelas são calculadas: alternar a análise
+    // exibida não refaz a prévia
+    m_previewWatcher.setFuture(QtConcurrent::run([this, audioFile, params, startTime, duration, generation]() {
+        QVector<SpectrogramTile> tiles;
+        for (int analysis = 0; analysis < params.numAnalyses(); ++analysis) {
+            SpectrogramTile tile = SpectrogramCalculator::computePreview(
+                *audioFile, params.analysis(analysis), startTime, duration,
+                kPreviewColumns, [this, generation]() {
+                    return m_previewGeneration.load() != generation;
+                });
+            if (tile.isNull()) {
+                return QVector<SpectrogramTile>();
+            }
+            tiles.append(tile);
+        }
+        return tiles;
+    }));
+}
+
+void SpectrogramSettingsDialog::onPreviewFinished()
+{
+    QVector<SpectrogramTile> tiles = m_previewWatcher.result();
+    if (!tiles.isEmpty()) {
+        m_previewTiles = tiles;
+        m_previewTileParams = m_runningParams;
+        updatePreviewImage();
+    }
+    
+    if (m_previewPending) {
+        startPreview();
+    }
+}
+
+void SpectrogramSettingsDialog::updatePreviewImage()
+{
+    if (m_previewTiles.isEmpty() || !m_previewFile) {
+        return;
+    }
+    
+    // Análise exibida, como na visualização; empilhadas, a principal em cima
+    Settings settings = getSettings();
+    QVector<int> analyses;
+    if (m_previewTiles.size() < 2 || settings.dualDisplay == "Primary") {
+        analyses.append(0);
+    } else if (settings.dualDisplay == "Secondary") {
+        analyses.append(1);
+    } else {
+        analyses = {0, 1};
+    }
+    
+    const QVector<QRgb> palette = SpectrogramCalculator::palette(
+        settings.dynamicRange, SpectrogramCalculator::colorMapFromName(settings.colorMap));
+    const int numRows = kPreviewHeight / static_cast<int>(analyses.size());
+    QImage preview(kPreviewColumns, numRows * static_cast<int>(analyses.size()), QImage::Format_RGB32);
+    preview.fill(Qt::black);
+    QPainter painter(&preview);
+    for (int i = 0; i < analyses.size(); ++i) {
+        QImage image = previewImage(analyses[i], numRows, settings);
+        image.setColorTable(palette);
+        painter.drawImage(QRect(0, i * numRows, preview.width(), numRows), image);
+    }
+    painter.end();
+    m_previewLabel->setPixmap(QPixmap::fromImage(preview));
+}
+
+QImage SpectrogramSettingsDialog::previewImage(int analysis, int numRows, const Settings &settings) const
+{
+    // Mesma conversão da visualização: escala de frequência e níveis de
+    // 8 bits (a paleta fica com quem desenha)
+    const SpectrogramTile &tile = m_previewTiles[analysis];
+    SpectrogramCalculator::Geometry geometry = SpectrogramCalculator::computeGeometry(
+        m_previewTileParams.analysis(analysis), m_previewFile->getSampleRate(),
+        m_previewFile->getNumSamples());
+    double binFrequency = static_cast<double>(geometry.sampleRate) / geometry.fftSize;
+    FrequencyScale scale(FrequencyScale::typeFromName(settings.frequencyScale),
+                         geometry.minBin * binFrequency, geometry.maxBin * binFrequency);
+    
+    // Na escala linear a tabela só entra com mais bins que linhas: a imagem
+    // fica com a altura da prévia (máximo dos bins de cada linha, sem perder
+    // picos estreitos) em vez de um bin por linha
+    FrequencyRemap remap;
+    if (scale.type() != FrequencyScale::Linear || geometry.numBins() > numRows) {
+        remap = FrequencyRemap::build(scale, binFrequency, geometry.minBin, geometry.numBins(),
+                                      numRows);
+    }
+    return SpectrogramCalculator::quantize(tile, remap);
+}
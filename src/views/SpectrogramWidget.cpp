@@ -2,9 +2,33 @@
 #include "audio/SpectrogramCalculator.h"
 #include "models/AudioFile.h"
 #include <QPainter>
+#include <QPaintEvent>
 #include <QThread>
 #include <QWheelEvent>
 #include <QMouseEvent>
+#include <QResizeEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Margem pré-calculada em cada lado da janela visível (fração da janela)
+    const double kPrefetchFraction = 0.25;
+    
+    // Memória máxima (KB) das imagens dos tiles (1 byte por célula)
+    const int kMaxTileImageKB = 16 * 1024;
+    
+    // Mínimo de linhas das imagens nas escalas não lineares
+    const int kMinScaleRows = 256;
+    
+    // Espaço entre as duas análises empilhadas (pixels)
+    const int kStackSpacing = 6;
+    
+    // Chave da imagem de um tile: a análise ocupa os bits acima do nível
+    inline quint64 tileImageKey(int level, int index, int analysis)
+    {
+        return spectrogramTileKey(level, index) | (static_cast<quint64>(analysis) << 48);
+    }
+}
 
 SpectrogramWidget::SpectrogramWidget(QWidget *parent) 
     : QWidget(parent)
@@ -13,6 +37,10 @@ SpectrogramWidget::SpectrogramWidget(QWidget *parent)
     , m_playbackPosition(0.0)
     , m_isCalculating(false)
     , m_calculationProgress(0)
+    , m_currentGeneration(0)
+    , m_tileImages(kMaxTileImageKB)
+    , m_remapValid(false)
+    , m_pixmapValid(false)
     , m_isDragging(false)
     , m_dragStartX(0)
     , m_dragStartTime(0.0)
@@ -21,6 +49,9 @@ SpectrogramWidget::SpectrogramWidget(QWidget *parent)
 {
     setMinimumHeight(150);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    setMouseTracking(true);  // Leitura de dB sob o cursor
+    m_palette = SpectrogramCalculator::palette(
+        m_settings.dynamicRange, SpectrogramCalculator::colorMapFromName(m_settings.colorMap));
     
     // Criar calculador em thread separada
     m_calculatorThread = new QThread(this);
@@ -34,8 +65,12 @@ SpectrogramWidget::SpectrogramWidget(QWidget *parent)
             this, &SpectrogramWidget::calculationStarted);
     connect(m_calculator, &SpectrogramCalculator::calculationProgress,
             this, &SpectrogramWidget::onCalculationProgress);
+    connect(m_calculator, &SpectrogramCalculator::tileReady,
+            this, &SpectrogramWidget::onTileReady);
     connect(m_calculator, &SpectrogramCalculator::calculationFinished,
             this, &SpectrogramWidget::onCalculationFinished);
+    connect(m_calculator, &SpectrogramCalculator::calculationCancelled,
+            this, &SpectrogramWidget::onCalculationCancelled);
     connect(m_calculator, &SpectrogramCalculator::calculationError,
             this, &SpectrogramWidget::onCalculationError);
     
@@ -63,112 +98,496 @@ SpectrogramWidget::~SpectrogramWidget()
 void SpectrogramWidget::setAudioFile(std::shared_ptr<AudioFile> audioFile)
 {
     m_audioFile = audioFile;
+    m_tileImages.clear();
+    m_remapValid = false;
     
+    // Tiles do arquivo anterior não interessam mais
+    if (m_isCalculating) {
+        m_calculator->cancel();
+        setCalculating(false);
+    }
+    
+    // Mesma janela inicial da forma de onda: o arquivo inteiro
+    m_viewStartTime = 0.0;
     if (m_audioFile) {
-        // Verificar se já existe cache com as configurações atuais
-        QString settingsHash = getSettingsHash();
-        if (m_audioFile->hasSpectrogramCache(settingsHash)) {
-            m_spectrogramImage = m_audioFile->getSpectrogramCache();
-            m_isCalculating = false;
-            m_calculationProgress = 100;
-        } else {
-            m_spectrogramImage = QImage();  // Limpar espectrograma anterior
-            calculateSpectrogram();
-        }
-    } else {
-        m_spectrogramImage = QImage();
+        m_viewDuration = m_audioFile->getDuration();
     }
     
-    update();
+    requestVisibleTiles();
+    invalidateSpectrogram();
 }
 
 void SpectrogramWidget::setSettings(const Settings &settings)
 {
+    SpectrogramCalculator::Parameters previousParams = calculatorParameters();
+    bool scaleChanged = settings.frequencyScale != m_settings.frequencyScale;
     m_settings = settings;
+    m_remapValid = false;
     
-    // Limpar cache pois as configurações mudaram
-    if (m_audioFile) {
-        m_audioFile->clearSpectrogramCache();
+    // A escala do eixo muda as linhas das imagens, mas não os dB
+    if (scaleChanged) {
+        m_tileImages.clear();
+    }
+    
+    // Mapa de cores e faixa dinâmica só afetam a tabela de cores: os dB e
+    // as imagens quantizadas continuam válidos
+    m_palette = SpectrogramCalculator::palette(
+        m_settings.dynamicRange, SpectrogramCalculator::colorMapFromName(m_settings.colorMap));
+    if (calculatorParameters() == previousParams) {
+        invalidateSpectrogram();
+        return;
+    }
+    m_tileImages.clear();
+    
+    // Os tiles da configuração anterior continuam no cache compartilhado
+    // (voltar a ela não recalcula); os da nova são pedidos abaixo
+    if (m_isCalculating) {
+        m_calculator->cancel();
+        setCalculating(false);
     }
     
     if (m_audioFile) {
         calculateSpectrogram();
     }
+    invalidateSpectrogram();
 }
 
 void SpectrogramWidget::setPlaybackPosition(double timeSeconds)
 {
+    // Apenas as colunas sob a posição anterior e a nova do cursor são
+    // repintadas; o restante vem da imagem em cache
+    int previousX = cursorX(m_playbackPosition);
     m_playbackPosition = timeSeconds;
-    update();
+    int currentX = cursorX(m_playbackPosition);
+    if (currentX == previousX) {
+        return;
+    }
+    if (previousX >= 0) {
+        update(cursorRect(previousX));
+    }
+    if (currentX >= 0) {
+        update(cursorRect(currentX));
+    }
 }
 
 void SpectrogramWidget::setVisibleTimeRange(double startTime, double duration)
 {
     m_viewStartTime = startTime;
     m_viewDuration = duration;
+    requestVisibleTiles();
+    invalidateSpectrogram();
+}
+
+void SpectrogramWidget::invalidateSpectrogram()
+{
+    m_pixmapValid = false;
     update();
 }
 
+int SpectrogramWidget::cursorX(double timeSeconds) const
+{
+    int leftMargin = 50;
+    int rightMargin = 10;
+    int drawWidth = width() - leftMargin - rightMargin;
+    if (m_viewDuration <= 0.0 || timeSeconds < m_viewStartTime ||
+        timeSeconds > m_viewStartTime + m_viewDuration) {
+        return -1;
+    }
+    
+    double relativeTime = timeSeconds - m_viewStartTime;
+    return leftMargin + static_cast<int>((relativeTime / m_viewDuration) * drawWidth);
+}
+
+QRect SpectrogramWidget::cursorRect(int x) const
+{
+    // Linha de 2 px mais uma margem para o antialiasing
+    return QRect(x - 2, 0, 5, height());
+}
+
 void SpectrogramWidget::calculateSpectrogram()
 {
-    if (!m_audioFile || m_isCalculating) {
+    requestVisibleTiles();
+}
+
+void SpectrogramWidget::toggleDualAnalysis()
+{
+    if (calculatorParameters().numAnalyses() < 2) {
         return;
     }
-    
+    m_settings.dualDisplay = m_settings.dualDisplay == "Primary" ? "Secondary" : "Primary";
+    invalidateSpectrogram();
+}
+
+int SpectrogramWidget::plotWidth() const
+{
+    return width() - 50 - 10;
+}
+
+void SpectrogramWidget::setCalculating(bool calculating)
+{
+    if (calculating == m_isCalculating) {
+        return;
+    }
+    m_isCalculating = calculating;
+    emit calculatingChanged(calculating);
+}
+
+SpectrogramCalculator::Parameters SpectrogramWidget::calculatorParameters() const
+{
     // Converter Settings para Parameters
     SpectrogramCalculator::Parameters params;
     params.timeStep = m_settings.timeStep;
     params.timeWindow = m_settings.timeWindow;
     params.fftSize = m_settings.fftSize;
-    params.windowType = m_settings.windowType;
+    params.windowType = SpectrogramCalculator::windowTypeFromName(m_settings.windowType);
     params.minFrequency = m_settings.minFrequency;
     params.maxFrequency = m_settings.maxFrequency;
-    params.dynamicRange = m_settings.dynamicRange;
-    params.colorMap = m_settings.colorMap;
     params.preEmphasis = m_settings.preEmphasis;
     params.preEmphasisFactor = m_settings.preEmphasisFactor;
-    params.maxDuration = 20.0;
-    
-    // Se a janela visível for menor que 20s, calcular apenas a janela
-    if (m_viewDuration < 20.0 && m_viewDuration > 0) {
-        params.startTime = m_viewStartTime;
-        params.windowDuration = m_viewDuration;
+    params.secondaryTimeWindow = m_settings.secondaryTimeWindow;
+    return params;
+}
+
+SpectrogramCalculator::Geometry SpectrogramWidget::currentGeometry(int analysis) const
+{
+    if (!m_audioFile) {
+        return SpectrogramCalculator::Geometry();
+    }
+    // As análises só diferem na janela: tempo, frames e tiles são os mesmos
+    return SpectrogramCalculator::computeGeometry(calculatorParameters().analysis(analysis),
+                                                  m_audioFile->getSampleRate(),
+                                                  m_audioFile->getNumSamples());
+}
+
+QVector<QPair<int, QRect>> SpectrogramWidget::analysisAreas() const
+{
+    int leftMargin = 50;
+    int rightMargin = 10;
+    int topMargin = 10;
+    int bottomMargin = 10;
+    QRect plot(leftMargin, topMargin, width() - leftMargin - rightMargin,
+               height() - topMargin - bottomMargin);
+    
+    // Análise exibida e área de cada uma; empilhadas, a principal fica em cima
+    QVector<QPair<int, QRect>> areas;
+    if (calculatorParameters().numAnalyses() < 2 || m_settings.dualDisplay == "Primary") {
+        areas.append(qMakePair(0, plot));
+    } else if (m_settings.dualDisplay == "Secondary") {
+        areas.append(qMakePair(1, plot));
     } else {
-        // Calcular os primeiros 20s do áudio
-        params.startTime = 0.0;
-        params.windowDuration = 0.0; // 0 = usar maxDuration
+        int half = (plot.height() - kStackSpacing) / 2;
+        areas.append(qMakePair(0, QRect(plot.left(), plot.top(), plot.width(), half)));
+        areas.append(qMakePair(1, QRect(plot.left(), plot.bottom() + 1 - half, plot.width(), half)));
+    }
+    return areas;
+}
+
+int SpectrogramWidget::levelForView(const SpectrogramCalculator::Geometry &geometry) const
+{
+    int drawWidth = plotWidth();
+    if (!geometry.isValid() || drawWidth <= 0 || m_viewDuration <= 0.0) {
+        return 0;
     }
     
-    m_isCalculating = true;
-    m_calculator->calculate(m_audioFile, params);
+    // Menor nível com no máximo ~2 colunas por pixel
+    double columnsPerPixel = m_viewDuration / geometry.frameDuration / drawWidth;
+    int level = 0;
+    int maxLevel = geometry.maxLevel();
+    while (columnsPerPixel >= 2.0 && level < maxLevel) {
+        columnsPerPixel /= 2.0;
+        ++level;
+    }
+    return level;
 }
 
-void SpectrogramWidget::onCalculationFinished(QImage spectrogram)
+bool SpectrogramWidget::visibleTileRange(const SpectrogramCalculator::Geometry &geometry, int level,
+                                         int &firstTile, int &lastTile) const
 {
-    m_spectrogramImage = spectrogram;
-    m_isCalculating = false;
-    m_calculationProgress = 100;
+    if (!geometry.isValid() || m_viewDuration <= 0.0) {
+        return false;
+    }
+    
+    double tileDuration = geometry.tileDuration(level);
+    firstTile = std::max(0, static_cast<int>(std::floor(m_viewStartTime / tileDuration)));
+    lastTile = std::min(geometry.numTiles(level) - 1,
+                        static_cast<int>(std::floor((m_viewStartTime + m_viewDuration) / tileDuration)));
+    return firstTile <= lastTile;
+}
+
+void SpectrogramWidget::requestVisibleTiles()
+{
+    if (!m_audioFile) {
+        return;
+    }
     
-    // Salvar no cache do AudioFile com hash das configurações
-    if (m_audioFile && !spectrogram.isNull()) {
-        QString settingsHash = getSettingsHash();
-        m_audioFile->setSpectrogramCache(spectrogram, settingsHash);
+    SpectrogramCalculator::Geometry geometry = currentGeometry();
+    int level = levelForView(geometry);
+    int firstTile = 0;
+    int lastTile = -1;
+    if (!visibleTileRange(geometry, level, firstTile, lastTile)) {
+        return;
     }
     
+    // Janela visível mais uma pequena margem em cada lado
+    int margin = std::max(1, static_cast<int>(std::ceil(
+        m_viewDuration * kPrefetchFraction / geometry.tileDuration(level))));
+    int first = std::max(0, firstTile - margin);
+    int last = std::min(geometry.numTiles(level) - 1, lastTile + margin);
+    
+    // Apenas tiles que ainda não estão no cache; os filhos já calculados
+    // são enviados para que o nível seja obtido por pooling, sem FFT
+    SpectrogramCache &cache = SpectrogramCache::instance();
+    SpectrogramCalculator::Parameters params = calculatorParameters();
+    QVector<int> missingTiles;
+    QVector<SpectrogramTile> sources;
+    
+    // Ordem de cálculo: tiles visíveis primeiro, depois a margem, do mais
+    // próximo ao mais distante da janela
+    QVector<int> candidates;
+    for (int tile = firstTile; tile <= lastTile; ++tile) {
+        candidates.append(tile);
+    }
+    for (int distance = 1; firstTile - distance >= first || lastTile + distance <= last; ++distance) {
+        if (lastTile + distance <= last) {
+            candidates.append(lastTile + distance);
+        }
+        if (firstTile - distance >= first) {
+            candidates.append(firstTile - distance);
+        }
+    }
+    
+    // Na análise dupla um tile falta se faltar em qualquer das análises;
+    // uma prévia ainda falta (o cálculo a substitui pelo tile completo)
+    for (int tile : candidates) {
+        bool missing = false;
+        for (int analysis = 0; analysis < params.numAnalyses(); ++analysis) {
+            missing = missing || !cache.containsComplete(tileKey(level, tile, analysis));
+        }
+        if (!missing) {
+            continue;
+        }
+        missingTiles.append(tile);
+        
+        if (level > 0) {
+            for (int analysis = 0; analysis < params.numAnalyses(); ++analysis) {
+                for (int child = 2 * tile; child <= 2 * tile + 1; ++child) {
+                    SpectrogramTile source = cache.peek(tileKey(level - 1, child, analysis));
+                    if (!source.isNull() && !source.preview) {
+                        source.analysis = analysis;
+                        sources.append(source);
+                    }
+                }
+            }
+        }
+    }
+    
+    if (missingTiles.isEmpty()) {
+        return;
+    }
+    
+    // O mesmo pedido já está em andamento
+    if (m_isCalculating && m_jobs.contains(m_currentGeneration)) {
+        const CalculationJob &current = m_jobs[m_currentGeneration];
+        if (current.audioFile == m_audioFile && current.params == params &&
+            current.level == level && current.tiles == missingTiles) {
+            return;
+        }
+    }
+    
+    // Novo pedido: o calculador abandona o anterior (tiles já entregues
+    // continuam no cache)
+    CalculationJob job;
+    job.audioFile = m_audioFile;
+    job.params = params;
+    job.level = level;
+    job.tiles = missingTiles;
+    
+    quint64 generation = m_calculator->calculate(m_audioFile, params, level, missingTiles, sources);
+    if (generation == 0) {
+        return;
+    }
+    m_jobs.insert(generation, job);
+    m_currentGeneration = generation;
+    setCalculating(true);
+    m_calculationProgress = 0;
+}
+
+void SpectrogramWidget::onTileReady(quint64 generation, SpectrogramTile tile)
+{
+    auto it = m_jobs.constFind(generation);
+    if (it == m_jobs.constEnd() || tile.isNull()) {
+        return;
+    }
+    const CalculationJob &job = it.value();
+    
+    // Resultado atrasado de um pedido substituído: descartado se o arquivo
+    // ou os parâmetros de análise mudaram desde então
+    if (generation != m_currentGeneration &&
+        (job.audioFile != m_audioFile || job.params != calculatorParameters())) {
+        return;
+    }
+    
+    // Salvar no cache com o arquivo e os parâmetros (da análise) do pedido
+    SpectrogramCacheKey key;
+    key.fileId = job.audioFile->getId();
+    key.params = job.params.analysis(tile.analysis);
+    key.level = tile.level;
+    key.index = tile.index;
+    SpectrogramCache::instance().insert(key, tile);
+    
+    if (job.audioFile == m_audioFile) {
+        m_tileImages.remove(tileImageKey(tile.level, tile.index, tile.analysis));
+        invalidateSpectrogram();
+    }
+}
+
+QImage SpectrogramWidget::tileImage(int level, int index, int analysis)
+{
+    quint64 imageKey = tileImageKey(level, index, analysis);
+    QImage *cached = m_tileImages.object(imageKey);
+    if (cached) {
+        // Troca de paleta: 256 cores, sem tocar nos pixels
+        if (cached->colorTable() != m_palette) {
+            cached->setColorTable(m_palette);
+        }
+        return *cached;
+    }
+    
+    // Imagem sob demanda a partir dos níveis em cache (ou dos dB, se o
+    // cache guarda float)
+    SpectrogramCacheKey key = tileKey(level, index, analysis);
+    SpectrogramCache &cache = SpectrogramCache::instance();
+    if (!cache.contains(key)) {
+        return QImage();
+    }
+    QByteArray levels;
+    SpectrogramTile tile = cache.tileLevels(key, levels);
+    if (tile.isNull()) {
+        return QImage();
+    }
+    QImage image = levels.isEmpty()
+        ? SpectrogramCalculator::quantize(tile, frequencyRemap(analysis))
+        : SpectrogramCalculator::quantize(tile, levels, frequencyRemap(analysis));
+    if (image.isNull()) {
+        return image;
+    }
+    image.setColorTable(m_palette);
+    m_tileImages.insert(imageKey, new QImage(image),
+                        std::max<int>(1, static_cast<int>(image.sizeInBytes() / 1024)));
+    return image;
+}
+
+QVector<int> SpectrogramWidget::drawLevels(const SpectrogramCalculator::Geometry &geometry) const
+{
+    // Enquanto o nível ideal é calculado, os níveis vizinhos já presentes no
+    // cache cobrem a área; o nível ideal vem por último (desenhado por cima)
+    int level = levelForView(geometry);
+    QVector<int> levels;
+    if (level < geometry.maxLevel()) {
+        levels.append(level + 1);
+    }
+    if (level > 0) {
+        levels.append(level - 1);
+    }
+    levels.append(level);
+    return levels;
+}
+
+bool SpectrogramWidget::valueAt(const QPoint &pos, double &timeSeconds,
+                                double &frequency, double &db) const
+{
+    if (!m_audioFile) {
+        return false;
+    }
+    
+    // Análise sob o ponto (duas, se empilhadas)
+    int analysis = -1;
+    QRect area;
+    for (const QPair<int, QRect> &candidate : analysisAreas()) {
+        if (candidate.second.contains(pos)) {
+            analysis = candidate.first;
+            area = candidate.second;
+        }
+    }
+    if (analysis < 0 || area.width() <= 0 || area.height() <= 0) {
+        return false;
+    }
+    
+    SpectrogramCalculator::Geometry geometry = currentGeometry(analysis);
+    if (!geometry.isValid()) {
+        return false;
+    }
+    
+    // Posição -> tempo e bin (frequências baixas embaixo), na escala do eixo
+    timeSeconds = m_viewStartTime + (pos.x() - area.left()) * m_viewDuration / area.width();
+    double relativeY = 1.0 - (pos.y() - area.top() + 0.5) / area.height();
+    frequency = frequencyScale(geometry).toFrequency(relativeY);
+    double binFrequency = static_cast<double>(geometry.sampleRate) / geometry.fftSize;
+    int bin = static_cast<int>(std::floor(frequency / binFrequency)) - geometry.minBin;
+    bin = std::max(0, std::min(geometry.numBins() - 1, bin));
+    
+    // Mesmo tile que está desenhado no ponto: o nível ideal tem prioridade
+    SpectrogramCache &cache = SpectrogramCache::instance();
+    QVector<int> levels = drawLevels(geometry);
+    for (int i = levels.size() - 1; i >= 0; --i) {
+        int level = levels[i];
+        int column = static_cast<int>(std::floor(timeSeconds / geometry.columnDuration(level)));
+        if (column < 0 || column >= geometry.numColumns(level)) {
+            continue;
+        }
+        
+        SpectrogramCacheKey key = tileKey(level, column / SpectrogramCalculator::TileFrames, analysis);
+        int local = column % SpectrogramCalculator::TileFrames;
+        if (cache.levelAt(key, local, bin, db)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SpectrogramWidget::onCalculationFinished(quint64 generation)
+{
+    m_jobs.remove(generation);
+    if (generation != m_currentGeneration) {
+        return;
+    }
+    
+    setCalculating(false);
+    m_calculationProgress = 100;
     emit calculationFinished();
     update();
 }
 
-void SpectrogramWidget::onCalculationProgress(int percent)
+void SpectrogramWidget::onCalculationCancelled(quint64 generation)
 {
+    m_jobs.remove(generation);
+    if (generation != m_currentGeneration) {
+        return;
+    }
+    
+    setCalculating(false);
+    update();
+}
+
+void SpectrogramWidget::onCalculationProgress(quint64 generation, int percent)
+{
+    if (generation != m_currentGeneration) {
+        return;
+    }
+    
     m_calculationProgress = percent;
     emit calculationProgress(percent);
     update();
 }
 
-void SpectrogramWidget::onCalculationError(QString error)
+void SpectrogramWidget::onCalculationError(quint64 generation, QString error)
 {
-    m_isCalculating = false;
+    m_jobs.remove(generation);
+    if (generation != 0 && generation != m_currentGeneration) {
+        return;
+    }
+    
+    setCalculating(false);
     emit calculationError(error);
     update();
 }
@@ -178,109 +597,127 @@ void SpectrogramWidget::paintEvent(QPaintEvent *event)
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
     
-    // Fundo branco quando não calculado, preto quando calculado
-    if (m_spectrogramImage.isNull()) {
+    if (!m_audioFile) {
         painter.fillRect(rect(), Qt::white);
-    } else {
-        painter.fillRect(rect(), Qt::black);
-    }
-    
-    if (m_isCalculating) {
-        // Mostrar progresso (fundo branco, texto preto)
         painter.setPen(Qt::black);
-        painter.drawText(rect(), Qt::AlignCenter, 
-                        QString("Calculando espectrograma... %1%").arg(m_calculationProgress));
+        painter.drawText(rect(), Qt::AlignCenter, "Espectrograma não calculado");
         return;
     }
     
-    if (m_spectrogramImage.isNull()) {
-        painter.setPen(Qt::black);
-        painter.drawText(rect(), Qt::AlignCenter, "Espectrograma não calculado");
-        return;
+    // Espectrograma e eixo ficam numa imagem do tamanho do widget, refeita
+    // apenas quando a janela, os tiles ou as cores mudam; o cursor de
+    // reprodução e o texto de progresso são desenhados por cima
+    qreal ratio = devicePixelRatioF();
+    QSize pixmapSize = size() * ratio;
+    if (!m_pixmapValid || m_pixmap.size() != pixmapSize) {
+        m_pixmap = QPixmap(pixmapSize);
+        m_pixmap.setDevicePixelRatio(ratio);
+        
+        // Fundo preto sob os tiles; tiles já calculados continuam visíveis
+        // enquanto os novos são calculados
+        m_pixmap.fill(Qt::black);
+        QPainter pixmapPainter(&m_pixmap);
+        pixmapPainter.setRenderHint(QPainter::Antialiasing);
+        drawSpectrogram(pixmapPainter);
+        drawFrequencyAxis(pixmapPainter);
+        m_pixmapValid = true;
     }
     
-    drawSpectrogram(painter);
-    drawFrequencyAxis(painter);
+    QRect dirty = event->rect();
+    painter.drawPixmap(dirty, m_pixmap,
+                       QRectF(dirty.topLeft() * ratio, dirty.size() * ratio).toRect());
     drawPlaybackCursor(painter);
+    
+    if (m_isCalculating) {
+        painter.setPen(Qt::white);
+        painter.drawText(rect().adjusted(0, 0, -15, -15), Qt::AlignRight | Qt::AlignBottom,
+                         QString("Calculando espectrograma... %1%").arg(m_calculationProgress));
+    }
 }
 
 void SpectrogramWidget::drawSpectrogram(QPainter &painter)
 {
-    if (m_spectrogramImage.isNull() || !m_audioFile) {
+    if (!m_audioFile) {
         return;
     }
     
-    int leftMargin = 50;
-    int rightMargin = 10;
-    int topMargin = 10;
-    int bottomMargin = 10;
-    
-    int drawWidth = width() - leftMargin - rightMargin;
-    int drawHeight = height() - topMargin - bottomMargin;
-    
-    if (drawWidth <= 0 || drawHeight <= 0) {
+    SpectrogramCalculator::Geometry geometry = currentGeometry();
+    if (!geometry.isValid()) {
         return;
     }
     
-    // Calcular região visível da imagem
-    double audioDuration = std::min(m_audioFile->getDuration(), 20.0);
-    double timePerPixel = audioDuration / m_spectrogramImage.width();
-    
-    int startPixel = static_cast<int>(m_viewStartTime / timePerPixel);
-    int endPixel = static_cast<int>((m_viewStartTime + m_viewDuration) / timePerPixel);
-    
-    startPixel = std::max(0, std::min(startPixel, m_spectrogramImage.width() - 1));
-    endPixel = std::max(startPixel + 1, std::min(endPixel, m_spectrogramImage.width()));
-    
-    int visibleWidth = endPixel - startPixel;
-    
-    // Extrair região visível
-    QImage visibleRegion = m_spectrogramImage.copy(startPixel, 0, visibleWidth, m_spectrogramImage.height());
-    
-    // Desenhar espectrograma escalado
-    QRect targetRect(leftMargin, topMargin, drawWidth, drawHeight);
-    painter.drawImage(targetRect, visibleRegion);
+    for (const QPair<int, QRect> &area : analysisAreas()) {
+        const int analysis = area.first;
+        const QRect &targetArea = area.second;
+        if (targetArea.width() <= 0 || targetArea.height() <= 0) {
+            continue;
+        }
+        
+        painter.save();
+        painter.setClipRect(targetArea);
+        
+        // Cada tile é desenhado na posição do seu intervalo de tempo
+        double pixelsPerSecond = targetArea.width() / m_viewDuration;
+        for (int drawLevel : drawLevels(geometry)) {
+            int firstTile = 0;
+            int lastTile = -1;
+            if (!visibleTileRange(geometry, drawLevel, firstTile, lastTile)) {
+                continue;
+            }
+            
+            for (int tile = firstTile; tile <= lastTile; ++tile) {
+                QImage image = tileImage(drawLevel, tile, analysis);
+                if (image.isNull()) {
+                    continue;
+                }
+                
+                double tileStart = tile * geometry.tileDuration(drawLevel);
+                double tileEnd = tileStart + image.width() * geometry.columnDuration(drawLevel);
+                QRectF target(targetArea.left() + (tileStart - m_viewStartTime) * pixelsPerSecond,
+                              targetArea.top(), (tileEnd - tileStart) * pixelsPerSecond,
+                              targetArea.height());
+                painter.drawImage(target, image, QRectF(image.rect()));
+            }
+        }
+        
+        painter.restore();
+    }
 }
 
 void SpectrogramWidget::drawFrequencyAxis(QPainter &painter)
 {
-    int leftMargin = 50;
-    int topMargin = 10;
-    int bottomMargin = 10;
-    int drawHeight = height() - topMargin - bottomMargin;
-    
     painter.setPen(Qt::white);
     painter.setFont(QFont("Arial", 8));
     
-    // Desenhar escala de frequência
-    double maxFreq = m_settings.maxFrequency;
-    int numTicks = 5;
-    
-    for (int i = 0; i <= numTicks; ++i) {
-        double freq = (maxFreq * i) / numTicks;
-        int y = topMargin + drawHeight - (i * drawHeight / numTicks);
+    // Um eixo por análise exibida, com marcas igualmente espaçadas na escala
+    for (const QPair<int, QRect> &area : analysisAreas()) {
+        const QRect &plot = area.second;
+        SpectrogramCalculator::Geometry geometry = currentGeometry(area.first);
+        FrequencyScale scale = geometry.isValid()
+            ? frequencyScale(geometry)
+            : FrequencyScale(FrequencyScale::typeFromName(m_settings.frequencyScale),
+                             m_settings.minFrequency, m_settings.maxFrequency);
+        int numTicks = plot.height() < 120 ? 2 : 5;
         
-        painter.drawLine(leftMargin - 5, y, leftMargin, y);
-        painter.drawText(QRect(0, y - 10, leftMargin - 10, 20), 
-                        Qt::AlignRight | Qt::AlignVCenter,
-                        QString::number(freq / 1000.0, 'f', 1) + " kHz");
+        for (int i = 0; i <= numTicks; ++i) {
+            double freq = scale.toFrequency(static_cast<double>(i) / numTicks);
+            int y = plot.top() + plot.height() - (i * plot.height() / numTicks);
+            
+            painter.drawLine(plot.left() - 5, y, plot.left(), y);
+            painter.drawText(QRect(0, y - 10, plot.left() - 10, 20),
+                            Qt::AlignRight | Qt::AlignVCenter,
+                            QString::number(freq / 1000.0, 'f', 1) + " kHz");
+        }
     }
 }
 
 void SpectrogramWidget::drawPlaybackCursor(QPainter &painter)
 {
-    if (m_playbackPosition < m_viewStartTime || 
-        m_playbackPosition > m_viewStartTime + m_viewDuration) {
+    int x = cursorX(m_playbackPosition);
+    if (x < 0) {
         return;
     }
     
-    int leftMargin = 50;
-    int rightMargin = 10;
-    int drawWidth = width() - leftMargin - rightMargin;
-    
-    double relativeTime = m_playbackPosition - m_viewStartTime;
-    int x = leftMargin + static_cast<int>((relativeTime / m_viewDuration) * drawWidth);
-    
     painter.setPen(QPen(Qt::red, 2));
     painter.drawLine(x, 0, x, height());
 }
@@ -318,8 +755,9 @@ void SpectrogramWidget::wheelEvent(QWheelEvent *event)
     m_viewStartTime = qMax(0.0, qMin(m_viewStartTime, maxDuration - newDuration));
     m_viewDuration = newDuration;
     
+    requestVisibleTiles();
     emit visibleTimeRangeChanged(m_viewStartTime, m_viewDuration);
-    update();
+    invalidateSpectrogram();
     event->accept();
 }
 
@@ -353,10 +791,19 @@ void SpectrogramWidget::mouseMoveEvent(QMouseEvent *event)
         double maxDuration = m_audioFile->getDuration();
         m_viewStartTime = qMax(0.0, qMin(m_viewStartTime, maxDuration - m_viewDuration));
         
+        // Apenas os tiles que entraram na janela são calculados
+        requestVisibleTiles();
         emit visibleTimeRangeChanged(m_viewStartTime, m_viewDuration);
-        update();
+        invalidateSpectrogram();
         event->accept();
     } else {
+        // Leitura do valor sob o cursor
+        double timeSeconds = 0.0;
+        double frequency = 0.0;
+        double db = 0.0;
+        if (valueAt(event->pos(), timeSeconds, frequency, db)) {
+            emit cursorValueChanged(timeSeconds, frequency, db);
+        }
         QWidget::mouseMoveEvent(event);
     }
 }
@@ -372,18 +819,50 @@ void SpectrogramWidget::mouseReleaseEvent(QMouseEvent *event)
     }
 }
 
-QString SpectrogramWidget::getSettingsHash() const
+void SpectrogramWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    
+    // A largura define o nível da pirâmide
+    requestVisibleTiles();
+}
+
+FrequencyScale SpectrogramWidget::frequencyScale(const SpectrogramCalculator::Geometry &geometry) const
+{
+    // Faixa efetivamente guardada nos tiles: bins minBin..maxBin - 1
+    double binFrequency = static_cast<double>(geometry.sampleRate) / geometry.fftSize;
+    return FrequencyScale(FrequencyScale::typeFromName(m_settings.frequencyScale),
+                          geometry.minBin * binFrequency, geometry.maxBin * binFrequency);
+}
+
+const FrequencyRemap &SpectrogramWidget::frequencyRemap(int analysis)
+{
+    if (!m_remapValid) {
+        const int numAnalyses = calculatorParameters().numAnalyses();
+        for (int a = 0; a < SpectrogramCalculator::MaxAnalyses; ++a) {
+            m_remaps[a] = FrequencyRemap();
+            SpectrogramCalculator::Geometry geometry = currentGeometry(a);
+            if (a >= numAnalyses || !geometry.isValid()) {
+                continue;
+            }
+            FrequencyScale scale = frequencyScale(geometry);
+            if (scale.type() != FrequencyScale::Linear) {
+                m_remaps[a] = FrequencyRemap::build(scale, static_cast<double>(geometry.sampleRate) / geometry.fftSize,
+                                                    geometry.minBin, geometry.numBins(),
+                                                    std::max(geometry.numBins(), kMinScaleRows));
+            }
+        }
+        m_remapValid = true;
+    }
+    return m_remaps[analysis];
+}
+
+SpectrogramCacheKey SpectrogramWidget::tileKey(int level, int index, int analysis) const
 {
-    // Criar hash único baseado nas configurações
-    return QString("%1_%2_%3_%4_%5_%6_%7_%8_%9_%10")
-        .arg(m_settings.timeStep, 0, 'f', 6)
-        .arg(m_settings.timeWindow, 0, 'f', 6)
-        .arg(m_settings.fftSize)
-        .arg(m_settings.windowType)
-        .arg(m_settings.minFrequency, 0, 'f', 1)
-        .arg(m_settings.maxFrequency, 0, 'f', 1)
-        .arg(m_settings.dynamicRange, 0, 'f', 1)
-        .arg(m_settings.colorMap)
-        .arg(m_settings.preEmphasis ? 1 : 0)
-        .arg(m_settings.preEmphasisFactor, 0, 'f', 3);
+    SpectrogramCacheKey key;
+    key.fileId = m_audioFile ? m_audioFile->getId() : 0;
+    key.params = calculatorParameters().analysis(analysis);
+    key.level = level;
+    key.index = index;
+    return key;
 }
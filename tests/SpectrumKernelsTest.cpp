@@ -0,0 +1,122 @@
+#include "audio/SpectrumKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Precisão de SpectrumKernels::powerToDb em cada implementação
+ *
+ * Força cada caminho (avx2, sse2, escalar) suportado pela CPU e compara
+ * powerToDb com powerToDbReference numa varredura de potências de MinPower
+ * a 1e6 (mais bins nulos, abaixo de MinPower): cada valor deve ficar a até
+ * MaxErrorDb da referência, e o mínimo e o máximo devem coincidir.
+ */
+
+namespace {
+    // Bins da varredura; não múltiplo de 8 para passar pelo resto escalar
+    const int kNumBins = 100003;
+
+    const double kMaxPower = 1e6;
+
+    std::vector<std::complex<float>> makeSweep()
+    {
+        std::vector<std::complex<float>> spectrum(kNumBins);
+        const double logMin = std::log10(static_cast<double>(SpectrumKernels::MinPower));
+        const double logMax = std::log10(kMaxPower);
+        for (int i = 0; i < kNumBins; ++i) {
+            // Potências em escala logarítmica, com a fase variando para que
+            // a parte real e a imaginária contribuam
+            double power = std::pow(10.0, logMin + (logMax - logMin) * i / (kNumBins - 1));
+            double magnitude = std::sqrt(power);
+            double phase = 0.7 * i;
+            spectrum[i] = std::complex<float>(static_cast<float>(magnitude * std::cos(phase)),
+                                              static_cast<float>(magnitude * std::sin(phase)));
+        }
+        // Bins nulos: limitados a MinPower
+        spectrum[1] = std::complex<float>(0.0f, 0.0f);
+        spectrum[kNumBins / 2] = std::complex<float>(0.0f, 0.0f);
+        return spectrum;
+    }
+
+    bool checkImplementation(const char *name, const std::vector<std::complex<float>> &spectrum,
+                             float referenceDb)
+    {
+        const int count = static_cast<int>(spectrum.size());
+        std::vector<float> db(count);
+        std::vector<float> expected(count);
+
+        float minDb = std::numeric_limits<float>::max();
+        float maxDb = std::numeric_limits<float>::lowest();
+        SpectrumKernels::powerToDb(spectrum.data(), count, referenceDb, db.data(), minDb, maxDb);
+
+        float expectedMin = std::numeric_limits<float>::max();
+        float expectedMax = std::numeric_limits<float>::lowest();
+        SpectrumKernels::powerToDbReference(spectrum.data(), count, referenceDb, expected.data(),
+                                            expectedMin, expectedMax);
+
+        float maxError = 0.0f;
+        int worst = 0;
+        for (int i = 0; i < count; ++i) {
+            float error = std::abs(db[i] - expected[i]);
+            if (!(error <= maxError)) {
+                maxError = error;
+                worst = i;
+            }
+        }
+
+        // Mínimo e máximo: os mesmos valores produzidos na saída
+        float outputMin = *std::min_element(db.begin(), db.end());
+        float outputMax = *std::max_element(db.begin(), db.end());
+
+        bool ok = true;
+        if (!(maxError <= SpectrumKernels::MaxErrorDb)) {
+            std::printf("FALHA [%s, ref %.1f dB]: erro %.3g dB no bin %d (%.6f != %.6f)\n",
+                        name, referenceDb, maxError, worst, db[worst], expected[worst]);
+            ok = false;
+        }
+        if (minDb != outputMin || maxDb != outputMax) {
+            std::printf("FALHA [%s, ref %.1f dB]: min/max %.6f/%.6f != saída %.6f/%.6f\n",
+                        name, referenceDb, minDb, maxDb, outputMin, outputMax);
+            ok = false;
+        }
+        if (!(std::abs(minDb - expectedMin) <= SpectrumKernels::MaxErrorDb)
+            || !(std::abs(maxDb - expectedMax) <= SpectrumKernels::MaxErrorDb)) {
+            std::printf("FALHA [%s, ref %.1f dB]: min/max %.6f/%.6f != referência %.6f/%.6f\n",
+                        name, referenceDb, minDb, maxDb, expectedMin, expectedMax);
+            ok = false;
+        }
+        if (ok) {
+            std::printf("ok [%s, ref %.1f dB]: erro máximo %.3g dB\n", name, referenceDb, maxError);
+        }
+        return ok;
+    }
+}
+
+int main()
+{
+    const std::vector<std::complex<float>> spectrum = makeSweep();
+    const char *names[] = {"avx2", "sse2", "scalar"};
+
+    bool ok = true;
+    int tested = 0;
+    for (const char *name : names) {
+        if (!SpectrumKernels::setImplementation(name)) {
+            std::printf("-- [%s] não suportada nesta CPU\n", name);
+            continue;
+        }
+        ++tested;
+        for (float referenceDb : {0.0f, 42.5f}) {
+            ok = checkImplementation(name, spectrum, referenceDb) && ok;
+        }
+    }
+
+    // A implementação escalar existe em qualquer CPU
+    if (tested == 0) {
+        std::printf("FALHA: nenhuma implementação disponível\n");
+        return 1;
+    }
+    return ok ? 0 : 1;
+}